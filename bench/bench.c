@@ -0,0 +1,306 @@
+/*
+ * bench.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * Driver benchmarks for QEMU. The drivers are built with REG_STUB, so their
+ * registers are RAM and each benchmark presets the status bits its driver waits
+ * on: the ADC's EOC, SysTick's COUNTFLAG for delay_us() and the LCD busy flag.
+ * Wait loops then fall through on their first poll, and what is measured is
+ * the driver's own code, not the time the hardware takes.
+ *
+ * QEMU runs with -icount shift=0, one instruction per virtual nanosecond, and
+ * the real SysTick counts the 25MHz board clock, so every tick is 40
+ * instructions. Each entry point is called enough times for that to round away.
+ * A run with an empty body is subtracted as the loop overhead. Times on the
+ * target are estimated at one instruction per cycle at CLOCK_SYSCLK, so they
+ * leave out flash wait states and pipeline stalls.
+ *
+ * Results are printed over semihosting as JSON, one benchmark per line, for
+ * run_bench.sh to stamp with the commit and compare.
+ */
+
+#include "bench.h"
+#include "ADC.h"
+#include "gpio.h"
+#include "keypad.h"
+#include "lcd.h"
+#include "system_clock.h"
+#include "timer.h"
+
+//real SysTick, the drivers' STK_ registers are stubs
+#define SYST_CSR	((volatile uint32_t*)0xE000E010)
+#define SYST_RVR	((volatile uint32_t*)0xE000E014)
+#define SYST_CVR	((volatile uint32_t*)0xE000E018)
+#define SYST_RELOAD	0x00FFFFFF
+
+//mps2-an386 clock and the -icount shift in run_bench.sh
+#define BENCH_SYSTICK_HZ	25000000
+#define BENCH_NS_PER_INSN	1
+#define BENCH_INSN_PER_TICK	(1000000000 / BENCH_SYSTICK_HZ / BENCH_NS_PER_INSN)
+
+#define BENCH_ADC_CODE		0x06A0			//about 1.37V, room temperature on the sensor
+#define BENCH_IDR_IDLE		0x00FF			//no key, LCD not busy
+#define BENCH_IDR_KEY		0x00EE			//row 1 and column 1, key 1
+#define BENCH_LINE			"0123456789ABCDEF"	//one full LCD row
+
+typedef struct {
+	const char *name;
+	void (*setup)();
+	void (*run)();
+	uint32_t iterations;
+} Bench;
+
+volatile uint32_t reg_stub_periph[REG_STUB_PERIPH_SIZE / 4];
+volatile uint32_t reg_stub_ppb[REG_STUB_PPB_SIZE / 4];
+
+static volatile uint32_t systick_wraps;
+static volatile uint32_t sink;
+static volatile float sink_f;
+
+static void setup_none();
+static void setup_adc();
+static void setup_lcd();
+static void setup_key_idle();
+static void setup_key_pressed();
+static void run_empty();
+static void run_take_sample();
+static void run_get_tempF();
+static void run_lcd_print_string();
+static void run_key_getkey_noblock();
+static void run_enable_clock();
+static void run_set_pin_mode();
+static void run_set_pin_output_type();
+static void run_set_output_speed();
+static void run_set_pin_PUPDR();
+static void run_set_alt_func();
+static uint64_t measure(const Bench *bench);
+static uint64_t systick_ticks();
+static char *put_str(char *out, const char *text);
+static char *put_u64(char *out, uint64_t value);
+static char *put_milli(char *out, uint64_t milli);
+
+static const Bench loop_bench = {"empty", setup_none, run_empty, 100000};
+
+static const Bench benches[] = {
+	{"take_sample",					setup_adc,			run_take_sample,			100000},
+	{"get_tempF",					setup_adc,			run_get_tempF,				20000},
+	{"lcd_print_string_16",			setup_lcd,			run_lcd_print_string,		500},
+	{"key_getkey_noblock_idle",		setup_key_idle,		run_key_getkey_noblock,		20000},
+	{"key_getkey_noblock_pressed",	setup_key_pressed,	run_key_getkey_noblock,		20000},
+	{"enable_clock",				setup_none,			run_enable_clock,			100000},
+	{"set_pin_mode",				setup_none,			run_set_pin_mode,			100000},
+	{"set_pin_output_type",			setup_none,			run_set_pin_output_type,	100000},
+	{"set_output_speed",			setup_none,			run_set_output_speed,		100000},
+	{"set_pin_PUPDR",				setup_none,			run_set_pin_PUPDR,			100000},
+	{"set_alt_func",				setup_none,			run_set_alt_func,			100000},
+};
+
+int main(){
+	//the drivers size their busy waits from the core clock, use the target's
+	SystemCoreClock = CLOCK_SYSCLK;
+
+	*SYST_RVR = SYST_RELOAD;
+	*SYST_CVR = 0;
+	*SYST_CSR = (1<<STK_ENABLE_F) | (1<<1) | (1<<STK_CLKSOURCE_F);	//count the core clock, interrupt on wrap
+
+	uint64_t loop_milli = measure(&loop_bench) * 1000 / loop_bench.iterations;
+
+	char line[192];
+	char *p = line;
+	p = put_str(p, "{\"suite\":\"drivers\",\"board\":\"mps2-an386\",\"cpu\":\"cortex-m4\",\"target_hz\":");
+	p = put_u64(p, CLOCK_SYSCLK);
+	p = put_str(p, ",\"loop_instructions\":");
+	p = put_milli(p, loop_milli);
+	p = put_str(p, ",\"benchmarks\":[\n");
+	semihost_write(line);
+
+	uint32_t count = sizeof(benches) / sizeof(benches[0]);
+	for(uint32_t i = 0; i < count; i++){
+		const Bench *bench = &benches[i];
+		uint64_t milli = measure(bench) * 1000 / bench->iterations;
+		milli = milli > loop_milli ? milli - loop_milli : 0;
+
+		p = put_str(line, "{\"name\":\"");
+		p = put_str(p, bench->name);
+		p = put_str(p, "\",\"iterations\":");
+		p = put_u64(p, bench->iterations);
+		p = put_str(p, ",\"instructions\":");
+		p = put_milli(p, milli);
+		p = put_str(p, ",\"target_ns\":");
+		p = put_milli(p, milli * 1000000 / (CLOCK_SYSCLK / 1000));
+		p = put_str(p, i+1 < count ? "},\n" : "}\n");
+		semihost_write(line);
+	}
+	semihost_write("]}\n");
+	return 0;
+}
+
+void SysTick_Handler(){
+	systick_wraps++;
+}
+
+/*
+ * Semihosting write of a zero terminated string to the host's stdout.
+ * Inputs:
+ * 		*text - string to print
+ * Outputs:
+ * 		none
+ */
+void semihost_write(const char *text){
+	register uint32_t r0 __asm("r0") = SYS_WRITE0;
+	register const char *r1 __asm("r1") = text;
+	__asm volatile("bkpt 0xAB" : "+r"(r0) : "r"(r1) : "memory");
+}
+
+/*
+ * Ends the run. QEMU exits with status 0 for an application exit and 1 for a
+ * run time error.
+ * Inputs:
+ * 		status - 0 on success
+ * Outputs:
+ * 		none, does not return
+ */
+void semihost_exit(int status){
+	register uint32_t r0 __asm("r0") = SYS_EXIT;
+	register uint32_t r1 __asm("r1") = status == 0 ? ADP_STOPPED_APPLICATION_EXIT : ADP_STOPPED_RUN_TIME_ERROR;
+	__asm volatile("bkpt 0xAB" : "+r"(r0) : "r"(r1) : "memory");
+	while(1){}
+}
+
+static void setup_none(){
+}
+
+static void setup_adc(){
+	*(ADC_SR) = (1<<ADC_SR_EOC_F);
+	*(ADC_DR) = BENCH_ADC_CODE;
+}
+
+static void setup_lcd(){
+	*(STK_CTRL) = (1<<STK_CNTFLAG_F);
+	*(GPIOC_IDR) = BENCH_IDR_IDLE;
+}
+
+static void setup_key_idle(){
+	*(GPIOC_IDR) = BENCH_IDR_IDLE;
+}
+
+static void setup_key_pressed(){
+	*(GPIOC_IDR) = BENCH_IDR_KEY;
+}
+
+static void run_empty(){
+}
+
+static void run_take_sample(){
+	sink = take_sample();
+}
+
+static void run_get_tempF(){
+	sink_f = get_tempF();
+}
+
+static void run_lcd_print_string(){
+	sink = lcd_print_string(BENCH_LINE);
+}
+
+static void run_key_getkey_noblock(){
+	sink = key_getkey_noblock();
+}
+
+static void run_enable_clock(){
+	enable_clock('C');
+}
+
+static void run_set_pin_mode(){
+	set_pin_mode('C', 8, OUTPUT);
+}
+
+static void run_set_pin_output_type(){
+	set_pin_output_type('C', 8, PUSH_PULL);
+}
+
+static void run_set_output_speed(){
+	set_output_speed('C', 8, FAST);
+}
+
+static void run_set_pin_PUPDR(){
+	set_pin_PUPDR('C', 8, PULLUP);
+}
+
+static void run_set_alt_func(){
+	set_alt_func('A', 8, 1);
+}
+
+/*
+ * Runs one benchmark and counts the instructions it took. The run function is
+ * called through a pointer so every benchmark pays the same call overhead as
+ * the empty one.
+ * Inputs:
+ * 		*bench - benchmark to run
+ * Outputs:
+ * 		instructions for all iterations
+ */
+static uint64_t measure(const Bench *bench){
+	void (*run)() = bench->run;
+	bench->setup();
+	uint64_t start = systick_ticks();
+	for(uint32_t i = 0; i < bench->iterations; i++){
+		run();
+	}
+	return (systick_ticks() - start) * BENCH_INSN_PER_TICK;
+}
+
+/*
+ * Reads the SysTick count extended with the wraps counted by its interrupt.
+ * Reads again if a wrap lands between the two reads.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		ticks since SysTick was started
+ */
+static uint64_t systick_ticks(){
+	uint32_t wraps, value;
+	do{
+		wraps = systick_wraps;
+		value = *SYST_CVR;
+	}while(wraps != systick_wraps);
+	return ((uint64_t)wraps << 24) + (SYST_RELOAD - value);
+}
+
+static char *put_str(char *out, const char *text){
+	while(*text != '\0'){
+		*out++ = *text++;
+	}
+	*out = '\0';
+	return out;
+}
+
+static char *put_u64(char *out, uint64_t value){
+	char digits[20];
+	int n = 0;
+	do{
+		digits[n++] = '0' + value % 10;
+		value /= 10;
+	}while(value != 0);
+	while(n > 0){
+		*out++ = digits[--n];
+	}
+	*out = '\0';
+	return out;
+}
+
+/*
+ * Prints thousandths as a decimal with three places.
+ */
+static char *put_milli(char *out, uint64_t milli){
+	out = put_u64(out, milli / 1000);
+	*out++ = '.';
+	uint32_t frac = milli % 1000;
+	*out++ = '0' + frac / 100;
+	*out++ = '0' + frac / 10 % 10;
+	*out++ = '0' + frac % 10;
+	*out = '\0';
+	return out;
+}
@@ -0,0 +1,23 @@
+/*
+ * bench.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <inttypes.h>
+
+//semihosting operations
+#define SYS_WRITE0					0x04
+#define SYS_EXIT					0x18
+#define ADP_STOPPED_APPLICATION_EXIT	0x20026
+#define ADP_STOPPED_RUN_TIME_ERROR	0x20023
+
+extern void semihost_write(const char *text);
+extern void semihost_exit(int status) __attribute__((noreturn));
+extern void SysTick_Handler();
+
+#endif /* BENCH_H */
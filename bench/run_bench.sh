@@ -0,0 +1,106 @@
+#!/bin/sh
+#
+# run_bench.sh
+#
+#  Created on: Oct 19, 2026
+#      Author: Mitchell Larson
+#
+# Builds the driver benchmark image and runs it under QEMU on the mps2-an386
+# board(Cortex-M4). Prints the results as JSON stamped with the commit, and
+# optionally saves them and compares them with an earlier run:
+#
+#     bench/run_bench.sh [-o results.json] [-b baseline.json]
+#
+# QEMU is run with -icount shift=0 so the counts are the same on every host;
+# bench.c relies on that shift. Results from different commits can be kept side
+# by side, e.g. -o bench/results/$(git rev-parse --short HEAD).json.
+#
+# With -b, the instructions per call of each benchmark are checked against the
+# baseline, and the run fails(exit 1) if any grew by more than THRESHOLD
+# percent. Overridable:
+#     QEMU		QEMU binary(default qemu-system-arm)
+#     THRESHOLD	allowed growth in percent(default 2)
+#     TIMEOUT	seconds before a hung image is killed(default 120)
+
+QEMU=${QEMU:-qemu-system-arm}
+THRESHOLD=${THRESHOLD:-2}
+TIMEOUT=${TIMEOUT:-120}
+OUT=
+BASELINE=
+
+while getopts o:b: opt; do
+	case $opt in
+	o) OUT="$OPTARG" ;;
+	b) BASELINE="$OPTARG" ;;
+	*) echo "usage: $0 [-o results.json] [-b baseline.json]" >&2; exit 2 ;;
+	esac
+done
+
+DIR=$(cd "$(dirname "$0")" && pwd)
+if [ -n "$BASELINE" ] && [ ! -f "$BASELINE" ]; then
+	echo "$0: no baseline $BASELINE" >&2
+	exit 2
+fi
+
+make -s -C "$DIR" >&2 || exit 1
+
+RAW=$(timeout "$TIMEOUT" "$QEMU" -M mps2-an386 -cpu cortex-m4 -nographic -monitor none -serial none \
+	-semihosting-config enable=on,target=native -icount shift=0 \
+	-kernel "$DIR/build/bench.elf")
+status=$?
+if [ $status -ne 0 ]; then
+	printf '%s\n' "$RAW" >&2
+	echo "$0: benchmark image failed(exit $status)" >&2
+	exit 1
+fi
+
+COMMIT=$(git -C "$DIR" rev-parse --short HEAD 2>/dev/null || echo unknown)
+if [ -n "$(git -C "$DIR" status --porcelain 2>/dev/null)" ]; then
+	COMMIT="$COMMIT-dirty"
+fi
+DATE=$(date -u +%Y-%m-%dT%H:%M:%SZ)
+RESULT=$(printf '%s\n' "$RAW" | sed "1s/^{/{\"commit\":\"$COMMIT\",\"date\":\"$DATE\",/")
+
+printf '%s\n' "$RESULT"
+if [ -n "$OUT" ]; then
+	printf '%s\n' "$RESULT" > "$OUT" || exit 1
+fi
+
+if [ -n "$BASELINE" ]; then
+	printf '%s\n' "$RESULT" | awk -v threshold="$THRESHOLD" '
+	function field(line, key,    start) {
+		start = index(line, "\"" key "\":")
+		if (start == 0) {
+			return ""
+		}
+		line = substr(line, start + length(key) + 3)
+		sub(/^"/, "", line)
+		sub(/[",}].*/, "", line)
+		return line
+	}
+	FNR == NR {
+		name = field($0, "name")
+		if (name != "") {
+			base[name] = field($0, "instructions")
+		}
+		next
+	}
+	{
+		name = field($0, "name")
+		if (name == "") {
+			next
+		}
+		now = field($0, "instructions")
+		if (!(name in base)) {
+			printf("%-28s %12.3f  new\n", name, now)
+			next
+		}
+		change = base[name] > 0 ? (now - base[name]) * 100 / base[name] : 0
+		flag = change > threshold ? "  REGRESSION" : ""
+		failed = failed || flag != ""
+		printf("%-28s %12.3f -> %12.3f  %+6.1f%%%s\n", name, base[name], now, change, flag)
+	}
+	END {
+		exit failed
+	}' "$BASELINE" - >&2 || exit 1
+fi
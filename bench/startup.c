@@ -0,0 +1,65 @@
+/*
+ * startup.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * Reset and exception handlers for the benchmark image. Copies .data, clears
+ * .bss, turns on the FPU and runs main(). Faults are reported over
+ * semihosting so a crashed run fails instead of hanging QEMU.
+ */
+
+#include <inttypes.h>
+#include "bench.h"
+
+#define CPACR	((volatile uint32_t*)0xE000ED88)	//real register, not a stub
+
+extern uint32_t _estack, _sidata, _sdata, _edata, _sbss, _ebss;
+extern int main();
+
+void Reset_Handler();
+void Fault_Handler();
+void Default_Handler();
+
+__attribute__((section(".isr_vector"), used))
+static void (* const vectors[16])() = {
+	(void (*)())&_estack,
+	Reset_Handler,
+	Default_Handler,		//NMI
+	Fault_Handler,			//HardFault
+	Fault_Handler,			//MemManage
+	Fault_Handler,			//BusFault
+	Fault_Handler,			//UsageFault
+	0, 0, 0, 0,
+	Default_Handler,		//SVCall
+	Default_Handler,		//DebugMonitor
+	0,
+	Default_Handler,		//PendSV
+	SysTick_Handler,
+};
+
+void Reset_Handler(){
+	uint32_t *src = &_sidata;
+	for(uint32_t *dst = &_sdata; dst < &_edata;){
+		*dst++ = *src++;
+	}
+	for(uint32_t *dst = &_sbss; dst < &_ebss;){
+		*dst++ = 0;
+	}
+
+	//full access to CP10 and CP11
+	*CPACR |= (0xF << 20);
+	__asm volatile("dsb\n\tisb");
+
+	semihost_exit(main());
+}
+
+void Fault_Handler(){
+	semihost_write("bench: fault\n");
+	semihost_exit(1);
+}
+
+void Default_Handler(){
+	semihost_write("bench: unexpected exception\n");
+	semihost_exit(1);
+}
@@ -9,30 +9,43 @@
 #define ADC_H
 
 //ADC constants
-#define ADC_BASE 	(volatile uint32_t*)	0x40012000
-#define ADC_SR 	 	(volatile uint32_t*)	0x40012000
-#define ADC_CR1	 	(volatile uint32_t*)	0x40012004
-#define ADC_CR2  	(volatile uint32_t*)	0x40012008
-#define ADC_SMPR1	(volatile uint32_t*)	0x4001200C
-#define ADC_SMPR2	(volatile uint32_t*)	0x40012010
-#define ADC_HTR		(volatile uint32_t*)	0x40012024
-#define ADC_LTR		(volatile uint32_t*)	0x40012028
-#define ADC_SQR1	(volatile uint32_t*)	0x4001202C
-#define ADC_SQR2	(volatile uint32_t*)	0x40012030
-#define ADC_SQR3	(volatile uint32_t*)	0x40012034
-#define ADC_DR		(volatile uint32_t*)	0x4001204C
+#define ADC_BASE 	REG32(0x40012000)
+#define ADC_SR 	 	REG32(0x40012000)
+#define ADC_CR1	 	REG32(0x40012004)
+#define ADC_CR2  	REG32(0x40012008)
+#define ADC_SMPR1	REG32(0x4001200C)
+#define ADC_SMPR2	REG32(0x40012010)
+#define ADC_HTR		REG32(0x40012024)
+#define ADC_LTR		REG32(0x40012028)
+#define ADC_SQR1	REG32(0x4001202C)
+#define ADC_SQR2	REG32(0x40012030)
+#define ADC_SQR3	REG32(0x40012034)
+#define ADC_DR		REG32(0x4001204C)
+#define ADC_CCR		REG32(0x40012304)
+
+//ADC register fields
+#define ADC_SR_EOC_F		1
+#define ADC_CR2_SWSTART_F	30
+#define ADC_CCR_ADCPRE_F	16
+#define ADC_MAX_CLK			36000000	//fastest ADC clock at 2.4-3.6V
 
 //RCC constants
-#define RCC_BASE	(volatile uint32_t*)	0x40023800
-#define APB2ENR		(volatile uint32_t*)	0x40023844
+#define RCC_BASE	REG32(0x40023800)
+#define APB2ENR		REG32(0x40023844)
 
 #include <inttypes.h>
+#include "reg.h"
 #include "gpio.h"
+#include "system_clock.h"
 
 extern void ADC_init();
 extern uint32_t take_sample();
 extern float get_tempC();
 extern float get_tempF();
 extern float get_mili_volts();
+extern void adc_start_conversion();
+extern uint8_t adc_conversion_done();
+extern uint32_t adc_read();
+extern int32_t adc_to_milliF(uint32_t code);
 
 #endif /* ADC_H */
@@ -0,0 +1,70 @@
+/*
+ * alarm.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef ALARM_H
+#define ALARM_H
+
+#include <inttypes.h>
+#include "rules.h"
+#include "rate.h"
+#include "pwm.h"
+
+//alarm constants
+#define ALARM_MIN_LED_DUTY	300		//dimmest LED level while the alarm is active
+
+/*
+ * Default rule table, one row per load in Load order, shared with the host
+ * replay tool. Thresholds are thousandths of a degree above the power-on
+ * temperature.
+ */
+#define ALARM_DEFAULT_RULES { \
+	/*load		on		off		min on	min off*/ \
+	{LOAD_LED,	5000,	0,		0,		0}, \
+	{LOAD_FAN,	3000,	0,		10000,	5000}, \
+	{LOAD_SIREN,7000,	2000,	3000,	30000}, \
+}
+
+//a fast ramp lights the LED and starts the fan before any threshold is reached
+#define ALARM_DEFAULT_RATE_TRIP	{3000, 1000, (1<<LOAD_LED) | (1<<LOAD_FAN), 0}
+
+/*
+ * Alarm decision state. The rule table and rate trip are owned by the caller,
+ * so the shell and the settings store can change them between steps.
+ */
+typedef struct {
+	Rule *rules;						//NUM_LOADS rows
+	RateTrip *trip;
+	RuleState states[NUM_LOADS];
+	RateEstimator rate;
+	int32_t power_on_milliF;			//reference the thresholds are measured from
+	int32_t offset_milliF;				//user offset added to each sample
+	int32_t rate_milliF;				//latest rate of rise, per minute
+	uint32_t next_rate_ms;				//time of the next rate window sample
+	uint32_t loads;						//loads energized by the last step
+} AlarmCore;
+
+/*
+ * Gate commands from one step, with what changed so the caller can log it.
+ */
+typedef struct {
+	int32_t milliF;				//sample with the offset applied
+	int32_t rise_milliF;		//above the power-on temperature
+	uint32_t loads;				//bit n set to energize Load n
+	uint32_t changed;			//loads switched by this step
+	uint16_t led_duty;
+	uint16_t siren_duty;
+	uint8_t fan_enable;			//fan under PID control
+	uint8_t rate_changed;		//rate trip tripped or released
+	uint8_t rate_updated;		//a rate window sample was taken, once per RATE_PERIOD
+} AlarmOutput;
+
+extern void alarm_init(AlarmCore *core, Rule *rules, RateTrip *trip, int32_t power_on_milliF, uint32_t now_ms);
+extern void alarm_set_offset(AlarmCore *core, int32_t offset_milliF);
+extern void alarm_set_power_on(AlarmCore *core, int32_t power_on_milliF);
+extern void alarm_step(AlarmCore *core, int32_t sensor_milliF, uint32_t now_ms, AlarmOutput *out);
+
+#endif /* ALARM_H */
@@ -0,0 +1,20 @@
+/*
+ * cobs.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef COBS_H
+#define COBS_H
+
+#include <inttypes.h>
+
+//worst case encoded size of len bytes, not counting the frame delimiter
+#define COBS_MAX_ENCODED(len) ((len) + ((len) / 254) + 1)
+
+extern uint32_t cobs_encode(const uint8_t *in, uint32_t len, uint8_t *out);
+extern int32_t cobs_decode(const uint8_t *in, uint32_t len, uint8_t *out);
+extern uint16_t crc16_ccitt(const uint8_t *data, uint32_t len, uint16_t crc);
+
+#endif /* COBS_H */
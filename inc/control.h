@@ -0,0 +1,58 @@
+/*
+ * control.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include <inttypes.h>
+#include "reg.h"
+#include "ADC.h"
+#include "pwm.h"
+#include "pid.h"
+#include "tach.h"
+#include "nvic.h"
+#include "system_clock.h"
+#include "history.h"
+#include "timer.h"
+#include "watchdog.h"
+#include "prof.h"
+#include "trace.h"
+
+//RCC constants
+#define RCC_APB1ENR REG32(0x40023840)
+#define TIM6_RCCEN_F 4
+
+//TIM6 constants(basic timer, APB1)
+#define TIM6_CR1	REG32(0x40001000)
+#define TIM6_DIER	REG32(0x4000100C)
+#define TIM6_SR		REG32(0x40001010)
+#define TIM6_PSC	REG32(0x40001028)
+#define TIM6_ARR	REG32(0x4000102C)
+#define TIM_DIER_UIE_F	0
+#define TIM_SR_UIF_F	0
+
+//control loop constants
+#define CONTROL_RATE_HZ		1000		//sample and PID update rate
+#define CONTROL_FILTER_SHIFT	7		//temperature filter, time constant of 2^7 updates
+#define CONTROL_IRQ_PRIORITY	1
+
+//fan PID tuning, error is in thousandths of a degree, output is PWM duty
+#define FAN_KP		PID_GAIN(0.2)		//full speed at 5 degrees over setpoint
+#define FAN_KI		1					//smallest Q16 gain, about 15 duty/s per degree of error
+#define FAN_KD		PID_GAIN(50.0)
+#define FAN_D_SHIFT	6
+
+extern void control_init(int32_t setpoint_milliF);
+extern void control_set_setpoint(int32_t setpoint_milliF);
+extern void control_set_offset(int32_t offset_milliF);
+extern int32_t control_get_offset();
+extern void control_enable_fan(uint8_t enable);
+extern int32_t control_get_milliF();
+extern float control_get_tempF();
+extern uint32_t control_get_raw();
+
+#endif /* CONTROL_H */
@@ -0,0 +1,29 @@
+/*
+ * dwt.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef DWT_H
+#define DWT_H
+
+#include <inttypes.h>
+#include "reg.h"
+
+//debug and trace constants
+#define DEMCR		REG32(0xE000EDFC)
+#define DWT_CTRL	REG32(0xE0001000)
+#define DWT_CYCCNT	REG32(0xE0001004)
+#define DEMCR_TRCENA_F		24
+#define DWT_CYCCNTENA_F		0
+
+//start the free running cycle counter
+#define DWT_INIT()	do{ *(DEMCR) |= (1<<DEMCR_TRCENA_F); \
+						*(DWT_CYCCNT) = 0; \
+						*(DWT_CTRL) |= (1<<DWT_CYCCNTENA_F); }while(0)
+
+//current core cycle count, wraps every 2^32 cycles
+#define DWT_CYCLES()	(*(DWT_CYCCNT))
+
+#endif /* DWT_H */
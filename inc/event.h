@@ -0,0 +1,57 @@
+/*
+ * event.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <inttypes.h>
+#include "timer.h"
+#include "dwt.h"
+#include "trace.h"
+
+/*
+ * Events in priority order, lower values are dispatched first. Control work
+ * is listed ahead of user interface work.
+ */
+typedef enum {
+	EVT_ALARM,			//evaluate load rules
+	EVT_SAMPLE,			//collect a temperature sample
+	EVT_TELEMETRY,		//send a telemetry frame
+	EVT_KEYPAD,			//scan the keypad
+	EVT_CONSOLE,		//a console line has been received
+	EVT_DISPLAY,		//refresh the LCD
+	EVT_PERSIST,		//write changed settings to flash
+	EVT_TASKS,			//resume waiting protothreads
+	NUM_EVENTS
+} Event;
+
+typedef void (*EventHandler)();
+
+//dispatch statistics for one event
+typedef struct {
+	uint32_t count;			//times the handler ran
+	uint32_t max_cycles;	//longest handler run
+	uint32_t total_cycles;	//cycles spent in the handler, wraps
+} EventStats;
+
+//dispatch statistics for the loop itself
+typedef struct {
+	uint32_t iterations;	//passes through the dispatch loop
+	uint32_t idle;			//passes that found no work and slept
+	uint32_t max_cycles;	//longest single pass
+} LoopStats;
+
+extern void event_init();
+extern void event_register(Event event, EventHandler handler);
+extern void event_every(Event event, uint32_t period_ms);
+extern void event_post(Event event);
+extern void event_run();
+extern void event_get_stats(Event event, EventStats *stats);
+extern void event_get_loop_stats(LoopStats *stats);
+extern void event_clear_stats();
+
+#endif /* EVENT_H */
@@ -0,0 +1,83 @@
+/*
+ * evlog.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef EVLOG_H
+#define EVLOG_H
+
+#include <inttypes.h>
+#include "reg.h"
+#include "flash.h"
+
+//RCC reset flags, recorded with each reset
+#define RCC_CSR REG32(0x40023874)
+#define RCC_CSR_RMVF_F 24
+#define RCC_CSR_FLAGS_F 24		//reset flags in the top byte: BOR, PIN, POR, SFT, IWDG, WWDG, LPWR
+#define RCC_CSR_IWDGRSTF_F 29
+
+/*
+ * Flash layout. Sectors 7 and 4 take turns holding a log of 16 byte records
+ * written in order:
+ * 		word 0		sequence number, counting up across erases
+ * 		word 1		milliseconds since the reset
+ * 		word 2		data
+ * 		word 3		type in bits 0-7, argument in bits 8-15, CRC-16 of the rest in bits 16-31
+ * Word 3 is programmed last, so a record torn by a power loss fails its CRC.
+ * The end of the log in a sector is the first record whose sequence word is
+ * erased. The sector with the newest record is being written, and the other
+ * holds the records before it, see evlog.c. Sector 4 is half the size of 7.
+ */
+#define EVLOG_SECTOR_A		7
+#define EVLOG_ADDR_A		FLASH_SECTOR7_ADDR
+#define EVLOG_SECTOR_B		4
+#define EVLOG_ADDR_B		FLASH_SECTOR4_ADDR
+#define EVLOG_RECORD_WORDS	4
+#define EVLOG_RECORDS_A		(FLASH_SECTOR_SIZE / (4*EVLOG_RECORD_WORDS))
+#define EVLOG_RECORDS_B		(FLASH_SECTOR4_SIZE / (4*EVLOG_RECORD_WORDS))
+#define EVLOG_BUFFER		32			//records held in RAM between flushes, enough for the first boot
+#define EVLOG_FLUSH_LEVEL	(EVLOG_BUFFER / 2)	//records pending when a flush is requested
+
+typedef enum {
+	EVLOG_RESET = 1,		//arg: RCC reset flags, data: boot count
+	EVLOG_ALARM_ON,			//arg: load, data: temperature in thousandths of a degree
+	EVLOG_ALARM_OFF,		//arg: load, data: temperature in thousandths of a degree
+	EVLOG_FAULT,			//arg: fault code, data: detail
+	EVLOG_CONFIG,			//arg: settings store key, data: new value
+	EVLOG_RATE_ON,			//arg: loads energized, data: rate in thousandths of a degree per minute
+	EVLOG_RATE_OFF,			//arg: loads released, data: rate in thousandths of a degree per minute
+} EvlogType;
+
+//fault codes
+#define EVLOG_FAULT_FLASH	1		//settings could not be written
+#define EVLOG_FAULT_WATCHDOG	2		//watchdog reset, data: late task or -1
+#define EVLOG_FAULT_FAN_STALL	3		//fan driven but not turning, data: RPM
+#define EVLOG_FAULT_CRASH	0x10	//ORed with the exception number, data: faulting pc
+
+typedef struct {
+	uint32_t seq;
+	uint32_t time_ms;
+	int32_t data;
+	uint8_t type;
+	uint8_t arg;
+} EvlogRecord;
+
+typedef struct {
+	uint32_t records;		//valid and torn records in flash
+	uint32_t next_seq;		//sequence number of the next record
+	uint32_t pending;		//records waiting in RAM
+	uint32_t dropped;		//records lost because the RAM buffer was full
+} EvlogInfo;
+
+typedef void (*EvlogFlushCallback)();
+
+extern int evlog_init();
+extern void evlog_post(EvlogType type, uint8_t arg, int32_t data);
+extern int evlog_flush();
+extern void evlog_set_flush_callback(EvlogFlushCallback callback);
+extern int evlog_read(uint32_t back, EvlogRecord *record);
+extern void evlog_get_info(EvlogInfo *info);
+
+#endif /* EVLOG_H */
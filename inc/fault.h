@@ -0,0 +1,65 @@
+/*
+ * fault.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef FAULT_H
+#define FAULT_H
+
+#include <inttypes.h>
+#include "reg.h"
+
+//system control block constants
+#define SCB_SHCSR REG32(0xE000ED24)
+#define SCB_CFSR REG32(0xE000ED28)
+#define SCB_HFSR REG32(0xE000ED2C)
+#define SCB_MMFAR REG32(0xE000ED34)
+#define SCB_BFAR REG32(0xE000ED38)
+#define SCB_AIRCR REG32(0xE000ED0C)
+#define SCB_SHCSR_MEMFAULTENA_F 16
+#define SCB_SHCSR_BUSFAULTENA_F 17
+#define SCB_SHCSR_USGFAULTENA_F 18
+#define SCB_AIRCR_RESET 0x05FA0004		//VECTKEY with SYSRESETREQ
+
+//memory the fault handler may read while walking the stack
+#define FAULT_SRAM_START	0x20000000
+#define FAULT_SRAM_END		0x20020000
+#define FAULT_CODE_START	0x08000000
+#define FAULT_CODE_END		0x08010000		//FLASH_DATA_START
+
+#define FAULT_MAGIC			0xDEADFA17
+#define FAULT_TRACE_DEPTH	8			//return addresses kept from the stack
+#define FAULT_SCAN_WORDS	128			//stack words searched for return addresses
+
+//exception numbers, as read from IPSR
+#define FAULT_HARD			3
+#define FAULT_MEMMANAGE		4
+#define FAULT_BUS			5
+#define FAULT_USAGE			6
+
+/*
+ * Crash record kept in RAM that is not cleared at start up, so it survives the
+ * reset that follows a fault. It is valid when magic and check agree.
+ */
+typedef struct {
+	uint32_t magic;
+	uint32_t type;					//exception number of the fault
+	uint32_t r0, r1, r2, r3, r12;	//stacked registers
+	uint32_t lr, pc, psr;
+	uint32_t sp;					//stack pointer before the exception
+	uint32_t exc_return;
+	uint32_t cfsr, hfsr, mmfar, bfar;
+	uint32_t time_ms;
+	uint32_t trace[FAULT_TRACE_DEPTH];	//likely return addresses, innermost first, 0 when unused
+	uint32_t reported;				//set once the record has been reported after the reset
+	uint32_t check;					//~magic
+} FaultRecord;
+
+extern void fault_init();
+extern const FaultRecord *fault_get();
+extern void fault_mark_reported();
+extern void fault_print(const FaultRecord *fault);
+
+#endif /* FAULT_H */
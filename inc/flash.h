@@ -0,0 +1,52 @@
+/*
+ * flash.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef FLASH_H
+#define FLASH_H
+
+#include <inttypes.h>
+#include "reg.h"
+#include "watchdog.h"
+
+//flash interface constants
+#define FLASH_ACR REG32(0x40023C00)
+#define FLASH_KEYR REG32(0x40023C04)
+#define FLASH_SR REG32(0x40023C0C)
+#define FLASH_CR REG32(0x40023C10)
+#define FLASH_KEY1 0x45670123
+#define FLASH_KEY2 0xCDEF89AB
+
+#define FLASH_ACR_DCEN_F 10
+#define FLASH_ACR_DCRST_F 12
+#define FLASH_SR_EOP_F 0
+#define FLASH_SR_BSY_F 16
+#define FLASH_SR_ERRORS 0xF2		//OPERR, WRPERR, PGAERR, PGPERR, PGSERR
+#define FLASH_CR_PG_F 0
+#define FLASH_CR_SER_F 1
+#define FLASH_CR_SNB_F 3
+#define FLASH_CR_PSIZE_F 8
+#define FLASH_CR_PSIZE_X32 2		//word programming, 2.7V to 3.6V supply
+#define FLASH_CR_STRT_F 16
+#define FLASH_CR_LOCK_F 31
+
+/*
+ * Sectors 4 to 7 are not used by the program image and are reserved for
+ * persistent data. LinkerScript.ld keeps the image below FLASH_DATA_START.
+ */
+#define FLASH_DATA_START	0x08010000
+#define FLASH_SECTOR4_ADDR	0x08010000
+#define FLASH_SECTOR4_SIZE	0x10000		//64KB
+#define FLASH_SECTOR5_ADDR	0x08020000
+#define FLASH_SECTOR6_ADDR	0x08040000
+#define FLASH_SECTOR7_ADDR	0x08060000
+#define FLASH_SECTOR_SIZE	0x20000		//sectors 5 to 7 are 128KB
+#define FLASH_ERASED		0xFFFFFFFF
+
+extern int flash_erase_sector(uint8_t sector);
+extern int flash_program(uint32_t addr, const uint32_t *words, uint32_t count);
+
+#endif /* FLASH_H */
@@ -0,0 +1,17 @@
+/*
+ * fmt.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef FMT_H
+#define FMT_H
+
+#include <inttypes.h>
+
+extern uint32_t fmt_str(char *buf, uint32_t size, uint32_t pos, const char *str);
+extern uint32_t fmt_int(char *buf, uint32_t size, uint32_t pos, int32_t value, uint8_t width);
+extern uint32_t fmt_milli(char *buf, uint32_t size, uint32_t pos, int32_t milli, uint8_t decimals, uint8_t width);
+
+#endif /* FMT_H */
@@ -9,46 +9,47 @@
 #define GPIO_H
  
 #include <inttypes.h>
+#include "reg.h"
 
 //RCC constants 
-#define RCC_AHB1ENR (volatile uint32_t*) 	0x40023830
+#define RCC_AHB1ENR REG32(0x40023830)
 #define GPIOA_RCCEN_F 0
 #define GPIOB_RCCEN_F 1
 #define GPIOC_RCCEN_F 2
 
 //GPIO constants
-#define GPIOA_MODER	(volatile uint32_t*) 	0x40020000
-#define GPIOA_OTYPER (volatile uint32_t*) 	0x40020004
-#define GPIOA_OSPEEDR (volatile uint32_t*) 	0x40020008
-#define GPIOA_PUPDR	(volatile uint32_t*) 	0x4002000C
-#define GPIOA_IDR (volatile uint32_t*) 		0x40020010
-#define GPIOA_ODR (volatile uint32_t*) 		0x40020014
-#define GPIOA_BSSR (volatile uint32_t*) 	0x40020018
-#define GPIOA_LCKR (volatile uint32_t*) 	0x4002001C
-#define GPIOA_AFRL (volatile uint32_t*) 	0x40020020
-#define GPIOA_AFRH (volatile uint32_t*) 	0x40020024
+#define GPIOA_MODER	REG32(0x40020000)
+#define GPIOA_OTYPER REG32(0x40020004)
+#define GPIOA_OSPEEDR REG32(0x40020008)
+#define GPIOA_PUPDR	REG32(0x4002000C)
+#define GPIOA_IDR REG32(0x40020010)
+#define GPIOA_ODR REG32(0x40020014)
+#define GPIOA_BSSR REG32(0x40020018)
+#define GPIOA_LCKR REG32(0x4002001C)
+#define GPIOA_AFRL REG32(0x40020020)
+#define GPIOA_AFRH REG32(0x40020024)
 
-#define GPIOB_MODER	(volatile uint32_t*) 	0x40020400
-#define GPIOB_OTYPER (volatile uint32_t*) 	0x40020404
-#define GPIOB_OSPEEDR (volatile uint32_t*) 	0x40020408
-#define GPIOB_PUPDR	(volatile uint32_t*) 	0x4002040C
-#define GPIOB_IDR (volatile uint32_t*) 		0x40020410
-#define GPIOB_ODR (volatile uint32_t*) 		0x40020414
-#define GPIOB_BSSR (volatile uint32_t*) 	0x40020418
-#define GPIOB_LCKR (volatile uint32_t*) 	0x4002041C
-#define GPIOB_AFRL (volatile uint32_t*) 	0x40020420
-#define GPIOB_AFRH (volatile uint32_t*) 	0x40020424
+#define GPIOB_MODER	REG32(0x40020400)
+#define GPIOB_OTYPER REG32(0x40020404)
+#define GPIOB_OSPEEDR REG32(0x40020408)
+#define GPIOB_PUPDR	REG32(0x4002040C)
+#define GPIOB_IDR REG32(0x40020410)
+#define GPIOB_ODR REG32(0x40020414)
+#define GPIOB_BSSR REG32(0x40020418)
+#define GPIOB_LCKR REG32(0x4002041C)
+#define GPIOB_AFRL REG32(0x40020420)
+#define GPIOB_AFRH REG32(0x40020424)
 
-#define GPIOC_MODER	(volatile uint32_t*) 	0x40020800
-#define GPIOC_OTYPER (volatile uint32_t*) 	0x40020804
-#define GPIOC_OSPEEDR (volatile uint32_t*) 	0x40020808
-#define GPIOC_PUPDR	(volatile uint32_t*) 	0x4002080C
-#define GPIOC_IDR (volatile uint32_t*) 		0x40020810
-#define GPIOC_ODR (volatile uint32_t*) 		0x40020814
-#define GPIOC_BSSR (volatile uint32_t*) 	0x40020818
-#define GPIOC_LCKR (volatile uint32_t*) 	0x4002081C
-#define GPIOC_AFRL (volatile uint32_t*) 	0x40020820
-#define GPIOC_AFRH (volatile uint32_t*) 	0x40020824
+#define GPIOC_MODER	REG32(0x40020800)
+#define GPIOC_OTYPER REG32(0x40020804)
+#define GPIOC_OSPEEDR REG32(0x40020808)
+#define GPIOC_PUPDR	REG32(0x4002080C)
+#define GPIOC_IDR REG32(0x40020810)
+#define GPIOC_ODR REG32(0x40020814)
+#define GPIOC_BSSR REG32(0x40020818)
+#define GPIOC_LCKR REG32(0x4002081C)
+#define GPIOC_AFRL REG32(0x40020820)
+#define GPIOC_AFRH REG32(0x40020824)
 
 //enumerated types
 typedef enum {INPUT, OUTPUT, ALTFUNC, ANALOG} Mode;
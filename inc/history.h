@@ -0,0 +1,41 @@
+/*
+ * history.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <inttypes.h>
+#include "pt.h"
+
+//history store constants
+#define HISTORY_SIZE		8192		//bytes of SRAM for compressed samples
+#define HISTORY_BLOCK_SIZE	256			//samples are kept in blocks, the oldest block is dropped when full
+#define HISTORY_BLOCKS		(HISTORY_SIZE / HISTORY_BLOCK_SIZE)
+#define HISTORY_HEADER_SIZE	6			//absolute time(4) and temperature(2) starting each block
+#define HISTORY_PERIOD		1000		//milliseconds between samples
+
+/*
+ * Record encoding after the block header:
+ * 		0x00-0x7F	one second later, temperature change zigzag encoded in 7 bits
+ * 		0x80		varint seconds later, then varint zigzag temperature change
+ */
+#define HISTORY_ESCAPE		0x80
+
+typedef struct {
+	uint32_t samples;		//samples held
+	uint32_t bytes;			//bytes used
+	uint32_t oldest_s;		//time of the oldest sample held
+	uint32_t newest_s;		//time of the newest sample
+	uint32_t dropped;		//samples dropped with old blocks
+} HistoryInfo;
+
+extern void history_init();
+extern void history_append(uint32_t time_s, int16_t temp_tenths);
+extern void history_get_info(HistoryInfo *info);
+extern PT_THREAD(history_dump_pt(PT *pt));
+
+#endif /* HISTORY_H */
@@ -10,6 +10,15 @@
 
 #include <inttypes.h>
 #include "gpio.h"
+#include "system_clock.h"
+
+//keypad scan constants(PC0-3 columns, PC4-7 rows)
+#define KEY_MODER_MASK		0xFFFF	//mode bits for PC0-7
+#define KEY_MODER_ROWS_OUT	0x5500	//PC4-7 output, PC0-3 input
+#define KEY_MODER_COLS_OUT	0x0055	//PC0-3 output, PC4-7 input
+#define KEY_SETTLE_NS		250		//pull up rise time after a direction change
+#define KEY_LOOP_CYCLES		4		//fewest core cycles per settle loop pass: nop, add, compare, branch
+#define KEY_SETTLE_LOOPS	((SystemCoreClock / 1000000 * KEY_SETTLE_NS / 1000 + KEY_LOOP_CYCLES - 1) / KEY_LOOP_CYCLES)
 
 //global functions
 void key_init();
@@ -0,0 +1,59 @@
+/*
+ * kv_store.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef KV_STORE_H
+#define KV_STORE_H
+
+#include <inttypes.h>
+#include "flash.h"
+
+/*
+ * Flash layout. Two sectors are used in turn, each a log of 8 byte records:
+ * 		word 0		key in the low half, CRC-16 of key and value in the high half
+ * 		word 1		value
+ * The first record of a sector holds its generation under KV_HEADER_KEY and is
+ * written last when a sector is filled from the other, so a sector is only
+ * trusted once it is complete. The sector with the newest valid header is active,
+ * and the last record for a key in it is the current value. The other sector is
+ * kept erased for the next copy, see kv_store.c.
+ */
+#define KV_SECTOR_A			5
+#define KV_SECTOR_A_ADDR	FLASH_SECTOR5_ADDR
+#define KV_SECTOR_B			6
+#define KV_SECTOR_B_ADDR	FLASH_SECTOR6_ADDR
+#define KV_RECORD_SIZE		8
+#define KV_HEADER_KEY		0xFFFE
+#define KV_MAX_KEYS			32			//distinct keys held in RAM
+
+//application keys
+#define KV_KEY_BOOTS		0x0001		//boot counter
+#define KV_KEY_POWER_ON		0x0002		//power-on temperature, thousandths of a degree
+#define KV_KEY_OFFSET		0x0003		//user calibration offset, degrees
+#define KV_KEY_RATE_ON		0x0004		//rate of rise trip, thousandths of a degree per minute
+#define KV_KEY_RATE_OFF		0x0005		//rate of rise release, thousandths of a degree per minute
+#define KV_KEY_RATE_LOADS	0x0006		//loads energized by the rate of rise trip
+#define KV_KEY_FAULTS		0x0007		//crashes recovered from
+#define KV_KEY_RULE(load, field)	(0x0010 + 4*(load) + (field))	//field: 0 on, 1 off, 2 min on, 3 min off
+
+typedef struct {
+	uint32_t keys;			//keys held
+	uint32_t pending;		//changed keys not yet written
+	uint32_t used;			//bytes used in the active sector
+	uint32_t generation;	//times the store has been compacted
+	uint32_t bad;			//records skipped for a bad CRC at load
+	uint32_t spare;			//1 while the other sector is erased and ready for a copy
+} KvInfo;
+
+extern int kv_init();
+extern int kv_get(uint16_t key, int32_t *value);
+extern int kv_set(uint16_t key, int32_t value);
+extern int kv_commit();
+extern uint32_t kv_pending();
+extern int kv_erase();
+extern void kv_get_info(KvInfo *info);
+
+#endif /* KV_STORE_H */
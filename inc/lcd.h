@@ -10,16 +10,19 @@
 
 //included libraries
 #include <inttypes.h>
+#include "reg.h"
 #include "gpio.h"
-#include <stdio.h>
 #include "timer.h"
+#include "pt.h"
+#include "dwt.h"
+#include "prof.h"
  
 //RCC constants
-#define RCC_AHB1ENR (volatile uint32_t*) 0x40023830
+#define RCC_AHB1ENR REG32(0x40023830)
 #define GPIOB_EN_F 1
  
 //GPIO constants
-#define GPIOB_BASE (volatile uint32_t*) 0x40020400
+#define GPIOB_BASE REG32(0x40020400)
 
 //LCD constants
 #define LCD_DATA_OFFSET  8
@@ -29,6 +32,15 @@
 
 #define MAX_INT 9
 
+//LCD commands
+#define LCD_CLEAR_CMD	0x01
+#define LCD_HOME_CMD	0x02
+#define LCD_ROW1_CMD	0xC0		//set DDRAM address to the start of line 1
+
+//time between sending a command and polling the busy flag
+#define LCD_BUSY_DELAY_US		85
+#define LCD_BUSY_DELAY_CYCLES	(LCD_BUSY_DELAY_US * (SystemCoreClock / 1000000))
+
 typedef enum {C_OFF, C_ON} Cursor_Mode;
 
 extern void lcd_init(Cursor_Mode mode);
@@ -42,5 +54,8 @@ extern void lcd_data(uint8_t data);
 extern void lcd_set_position(uint8_t row,uint8_t col);
 extern int lcd_print_string(const char *pointer);
 extern int lcd_print_num(int num);
+extern PT_THREAD(lcd_cmd_pt(PT *pt, uint8_t command));
+extern PT_THREAD(lcd_data_pt(PT *pt, uint8_t data));
+extern PT_THREAD(lcd_print_string_pt(PT *pt, const char *pointer));
 
 #endif /* LCD_H */
@@ -0,0 +1,71 @@
+/*
+ * nvic.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef NVIC_H
+#define NVIC_H
+
+#include <inttypes.h>
+#include "reg.h"
+
+//NVIC constants
+#define NVIC_ISER0	REG32(0xE000E100)
+#define NVIC_ICER0	REG32(0xE000E180)
+#define NVIC_IPR0	REG8(0xE000E400)
+
+//IRQ numbers used by the application
+#define DMA1_Stream6_IRQn	17
+#define TIM2_IRQn		28
+#define USART2_IRQn		38
+#define TIM6_DAC_IRQn	54
+#define TIM7_IRQn		55
+
+//enable an interrupt, set-enable registers ignore writes of 0
+#define NVIC_ENABLE(irq)	(*(NVIC_ISER0 + ((irq)>>5)) = (1<<((irq) & 0x1F)))
+#define NVIC_DISABLE(irq)	(*(NVIC_ICER0 + ((irq)>>5)) = (1<<((irq) & 0x1F)))
+
+//set priority of an interrupt, 0 is highest, only the upper 4 bits are implemented
+#define NVIC_PRIORITY(irq, pri)	(*(NVIC_IPR0 + (irq)) = ((pri)<<4))
+
+/*
+ * Disables interrupts and returns the previous interrupt mask, for short
+ * critical sections. Pass the result to irq_restore().
+ */
+static inline uint32_t irq_save(){
+	uint32_t primask;
+#ifdef SIM_HOST
+	primask = sim_primask;
+	sim_primask = 1;
+#else
+	__asm__ volatile("mrs %0, primask\n\tcpsid i" : "=r"(primask) :: "memory");
+#endif
+	return primask;
+}
+
+/*
+ * Restores the interrupt mask saved by irq_save().
+ */
+static inline void irq_restore(uint32_t primask){
+#ifdef SIM_HOST
+	sim_primask = primask;
+#else
+	__asm__ volatile("msr primask, %0" :: "r"(primask) : "memory");
+#endif
+}
+
+/*
+ * Sleeps until the next interrupt. With interrupts masked it still wakes on
+ * one, which is then taken when they are unmasked.
+ */
+static inline void cpu_sleep(){
+#ifdef SIM_HOST
+	sim_wfi();
+#else
+	__asm__ volatile("wfi");
+#endif
+}
+
+#endif /* NVIC_H */
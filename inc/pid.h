@@ -0,0 +1,34 @@
+/*
+ * pid.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef PID_H
+#define PID_H
+
+#include <inttypes.h>
+
+//gains are Q16.16 fixed point, per controller update
+#define PID_Q 16
+#define PID_GAIN(x) ((int32_t)((x) * (1<<PID_Q)))
+
+typedef struct {
+	int32_t kp;				//proportional gain, output per unit of error
+	int32_t ki;				//integral gain, output per unit of error per update
+	int32_t kd;				//derivative gain, output per unit of change per update
+	int32_t out_min;		//output limits
+	int32_t out_max;
+	uint8_t d_shift;		//derivative filter, smoothing factor of 1/2^d_shift
+	int32_t integral;		//integrator state, Q16.16 output units
+	int32_t derivative;		//filtered derivative term, Q16.16 output units
+	int32_t prev_meas;
+	uint8_t primed;
+} PID;
+
+extern void pid_init(PID *pid, int32_t kp, int32_t ki, int32_t kd, int32_t out_min, int32_t out_max, uint8_t d_shift);
+extern void pid_reset(PID *pid);
+extern int32_t pid_update(PID *pid, int32_t setpoint, int32_t measurement);
+
+#endif /* PID_H */
@@ -0,0 +1,64 @@
+/*
+ * prof.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef PROF_H
+#define PROF_H
+
+#include <inttypes.h>
+#include "dwt.h"
+
+/*
+ * Profiled zones. Each zone is entered from one context only, an interrupt or
+ * the event loop, and is not re-entered before it ends.
+ */
+typedef enum {
+	PROF_CONTROL,		//control loop interrupt
+	PROF_PID,			//fan PID update
+	PROF_RULES,			//load rule and rate trip evaluation
+	PROF_STATS,			//once a second rate of rise and statistics update
+	PROF_FORMAT,		//formatting an LCD page
+	PROF_LCD_WAIT,		//LCD busy wait after a command or character, across yields
+	PROF_PERSIST,		//settings commit and event log flush
+	PROF_SHELL,			//one shell command
+	NUM_PROF_ZONES
+} ProfZone;
+
+//log2 latency histogram, bin 0 is under 2^(PROF_BIN_SHIFT+1) cycles, the last bin is open ended
+#define PROF_BINS		16
+#define PROF_BIN_SHIFT	4
+
+typedef struct {
+	uint32_t count;
+	uint32_t min_cycles;
+	uint32_t max_cycles;
+	uint64_t total_cycles;
+	uint32_t hist[PROF_BINS];
+} ProfStats;
+
+/*
+ * Zone markers read the cycle counter at the start and end of a zone. Unless
+ * PROFILE is defined they expand to nothing and the profiler is not built.
+ * PROF_INIT clears the table and runs once the cycle counter is started by
+ * event_init().
+ */
+#ifdef PROFILE
+extern uint32_t prof_start[NUM_PROF_ZONES];
+#define PROF_INIT()			prof_clear()
+#define PROF_BEGIN(zone)	(prof_start[(zone)] = DWT_CYCLES())
+#define PROF_END(zone)		prof_record((zone), DWT_CYCLES() - prof_start[(zone)])
+#else
+#define PROF_INIT()			((void)0)
+#define PROF_BEGIN(zone)	((void)0)
+#define PROF_END(zone)		((void)0)
+#endif
+
+extern void prof_record(ProfZone zone, uint32_t cycles);
+extern void prof_get(ProfZone zone, ProfStats *stats);
+extern void prof_clear();
+extern uint32_t prof_bin_low(uint8_t bin);
+
+#endif /* PROF_H */
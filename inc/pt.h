@@ -0,0 +1,62 @@
+/*
+ * pt.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * Stackless protothreads. A protothread is a function that can wait for a
+ * condition by returning to its caller, and resume at the same line the next
+ * time it is called. The only state kept between calls is the line number in
+ * the PT structure, so local variables do not survive a wait and must be static
+ * or passed in. Waits are not allowed inside a switch statement in the thread.
+ */
+
+#ifndef PT_H
+#define PT_H
+
+#include <inttypes.h>
+
+typedef struct {
+	uint16_t lc;		//line to resume at, 0 to start from the top
+} PT;
+
+//protothread return values
+#define PT_WAITING	0
+#define PT_YIELDED	1
+#define PT_EXITED	2
+#define PT_ENDED	3
+
+#define PT_THREAD(declaration) char declaration
+
+#define PT_INIT(pt)		((pt)->lc = 0)
+
+#define PT_BEGIN(pt)	{ char pt_yield_flag = 1; (void)pt_yield_flag; switch((pt)->lc){ case 0:
+
+#define PT_END(pt)		} pt_yield_flag = 0; PT_INIT(pt); return PT_ENDED; }
+
+//wait until a condition is true, returning to the caller while it is false
+#define PT_WAIT_UNTIL(pt, condition) \
+	do{ (pt)->lc = __LINE__; case __LINE__: \
+		if(!(condition)){ return PT_WAITING; } }while(0)
+
+#define PT_WAIT_WHILE(pt, condition)	PT_WAIT_UNTIL((pt), !(condition))
+
+//true while a child protothread has not finished
+#define PT_SCHEDULE(f)	((f) < PT_EXITED)
+
+//wait for a child protothread to finish
+#define PT_WAIT_THREAD(pt, thread)	PT_WAIT_WHILE((pt), PT_SCHEDULE(thread))
+
+//restart a child protothread and wait for it to finish
+#define PT_SPAWN(pt, child, thread) \
+	do{ PT_INIT((child)); PT_WAIT_THREAD((pt), (thread)); }while(0)
+
+//give other protothreads a turn, resuming on the next call
+#define PT_YIELD(pt) \
+	do{ pt_yield_flag = 0; (pt)->lc = __LINE__; case __LINE__: \
+		if(pt_yield_flag == 0){ return PT_YIELDED; } }while(0)
+
+//leave the protothread early
+#define PT_EXIT(pt)		do{ PT_INIT(pt); return PT_EXITED; }while(0)
+
+#endif /* PT_H */
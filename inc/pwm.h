@@ -0,0 +1,73 @@
+/*
+ * pwm.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef PWM_H
+#define PWM_H
+
+#include <inttypes.h>
+#include "reg.h"
+#include "gpio.h"
+#include "system_clock.h"
+
+//RCC constants
+#define RCC_APB1ENR REG32(0x40023840)
+#define RCC_APB2ENR REG32(0x40023844)
+#define TIM3_RCCEN_F 1
+#define TIM1_RCCEN_F 0
+
+//TIM1 constants(advanced control timer, APB2)
+#define TIM1_CR1	REG32(0x40010000)
+#define TIM1_EGR	REG32(0x40010014)
+#define TIM1_CCMR1	REG32(0x40010018)
+#define TIM1_CCER	REG32(0x40010020)
+#define TIM1_PSC	REG32(0x40010028)
+#define TIM1_ARR	REG32(0x4001002C)
+#define TIM1_CCR1	REG32(0x40010034)
+#define TIM1_CCR2	REG32(0x40010038)
+#define TIM1_BDTR	REG32(0x40010044)
+
+//TIM3 constants(general purpose timer, APB1)
+#define TIM3_CR1	REG32(0x40000400)
+#define TIM3_EGR	REG32(0x40000414)
+#define TIM3_CCMR1	REG32(0x40000418)
+#define TIM3_CCER	REG32(0x40000420)
+#define TIM3_PSC	REG32(0x40000428)
+#define TIM3_ARR	REG32(0x4000042C)
+#define TIM3_CCR2	REG32(0x40000438)
+
+//timer register fields
+#define TIM_CR1_CEN_F	0
+#define TIM_CR1_ARPE_F	7
+#define TIM_EGR_UG_F	0
+#define TIM_CCMR1_OC1PE_F	3
+#define TIM_CCMR1_OC1M_F	4
+#define TIM_CCMR1_OC2PE_F	11
+#define TIM_CCMR1_OC2M_F	12
+#define TIM_OCM_PWM1	0b110
+#define TIM_CCER_CC1E_F	0
+#define TIM_CCER_CC2E_F	4
+#define TIM_BDTR_MOE_F	15
+
+//PWM constants
+#define PWM_DUTY_MAX		1000		//duty cycle is expressed in tenths of a percent
+#define PWM_DEFAULT_FREQ	25000		//25kHz, above audible range for the fan
+
+//MOSFET gate pins on port A
+#define LOAD_LED_PIN	7
+#define LOAD_FAN_PIN	8
+#define LOAD_SIREN_PIN	9
+#define LOAD_ALL_MASK	((1<<LOAD_LED_PIN) | (1<<LOAD_FAN_PIN) | (1<<LOAD_SIREN_PIN))
+
+typedef enum {LOAD_LED, LOAD_FAN, LOAD_SIREN, NUM_LOADS} Load;
+
+extern void pwm_init(uint32_t freq_hz);
+extern void pwm_set_frequency(uint32_t freq_hz);
+extern void pwm_set_duty(Load load, uint16_t duty);
+extern uint16_t pwm_get_duty(Load load);
+extern void pwm_force_off();
+
+#endif /* PWM_H */
@@ -0,0 +1,48 @@
+/*
+ * rate.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef RATE_H
+#define RATE_H
+
+#include <inttypes.h>
+
+//rate of rise constants
+#define RATE_WINDOW		32			//samples in the slope window
+#define RATE_PERIOD		1000		//milliseconds between samples, a 32 second window
+#define RATE_MS_PER_MIN	60000
+
+/*
+ * Least squares slope over the last RATE_WINDOW samples, with the samples
+ * numbered 0 to RATE_WINDOW-1 oldest first. The sums are integers updated
+ * exactly as the window slides, so they never drift.
+ */
+typedef struct {
+	int32_t samples[RATE_WINDOW];	//ring of samples, thousandths of a degree
+	uint8_t head;					//oldest sample once the window is full
+	uint8_t count;					//samples held, up to RATE_WINDOW
+	int64_t sum;					//sum of the samples
+	int64_t sum_xy;					//sum of sample number times sample
+} RateEstimator;
+
+/*
+ * Rate of rise trip. Energizes the loads in the mask once the temperature is
+ * rising at on_rate or faster, until the rate falls to off_rate.
+ */
+typedef struct {
+	int32_t on_rate;		//trip at or above, thousandths of a degree per minute, 0 disables
+	int32_t off_rate;		//release at or below, thousandths of a degree per minute
+	uint32_t loads;			//bit n set to energize Load n while tripped
+	uint8_t active;			//run time state
+} RateTrip;
+
+extern void rate_init(RateEstimator *est);
+extern void rate_update(RateEstimator *est, int32_t milliF);
+extern uint8_t rate_valid(const RateEstimator *est);
+extern int32_t rate_per_minute(const RateEstimator *est, uint32_t period_ms);
+extern uint32_t rate_trip_evaluate(RateTrip *trip, const RateEstimator *est, int32_t rate);
+
+#endif /* RATE_H */
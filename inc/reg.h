@@ -0,0 +1,48 @@
+/*
+ * reg.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef REG_H
+#define REG_H
+
+#include <inttypes.h>
+
+/*
+ * Peripheral register access. On the target a register is its address. In the
+ * host simulator build(SIM_HOST) every access goes through sim_reg(), which
+ * returns the register's slot in a simulated register space and lets the
+ * peripheral models see the previous access and advance virtual time first.
+ */
+#ifdef SIM_HOST
+extern volatile uint32_t *sim_reg(uint32_t addr);
+extern volatile uint8_t *sim_reg8(uint32_t addr);
+extern uint32_t sim_primask;
+extern void sim_wfi();
+#define REG32(addr)	sim_reg(addr)
+#define REG8(addr)	sim_reg8(addr)
+#elif defined(REG_STUB)
+/*
+ * Benchmark build(REG_STUB): registers are plain RAM at the same offsets, so
+ * drivers run their real code paths, with no hardware behind them, on any
+ * Cortex-M. Addresses are still constants, so each access costs what it does on
+ * the target.
+ */
+#define REG_STUB_PERIPH_BASE	0x40000000u
+#define REG_STUB_PERIPH_SIZE	0x00030000u
+#define REG_STUB_PPB_BASE		0xE0000000u
+#define REG_STUB_PPB_SIZE		0x00043000u
+extern volatile uint32_t reg_stub_periph[REG_STUB_PERIPH_SIZE / 4];
+extern volatile uint32_t reg_stub_ppb[REG_STUB_PPB_SIZE / 4];
+#define REG8(addr)	((addr) >= REG_STUB_PPB_BASE \
+						? (volatile uint8_t*)reg_stub_ppb + ((addr) - REG_STUB_PPB_BASE) \
+						: (volatile uint8_t*)reg_stub_periph + ((addr) - REG_STUB_PERIPH_BASE))
+#define REG32(addr)	((volatile uint32_t*)REG8(addr))
+#else
+#define REG32(addr)	((volatile uint32_t*)(addr))
+#define REG8(addr)	((volatile uint8_t*)(addr))
+#endif
+
+#endif /* REG_H */
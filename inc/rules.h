@@ -0,0 +1,37 @@
+/*
+ * rules.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef RULES_H
+#define RULES_H
+
+#include <inttypes.h>
+#include "pwm.h"
+
+/*
+ * One row of the load rule table. Thresholds are in thousandths of a degree
+ * above the power-on temperature. A load turns on once the temperature reaches
+ * on_milliF and turns off once it falls to off_milliF, but never before it has
+ * been in its current state for the minimum time.
+ */
+typedef struct {
+	Load load;				//load(and gate pin) the rule drives
+	int32_t on_milliF;		//turn on at or above this rise
+	int32_t off_milliF;		//turn off at or below this rise
+	uint32_t min_on_ms;		//shortest time the load stays on
+	uint32_t min_off_ms;	//shortest time the load stays off
+} Rule;
+
+//run time state of a rule
+typedef struct {
+	uint8_t active;
+	uint32_t since_ms;		//time of the last change of state
+} RuleState;
+
+extern void rules_init(const Rule *rules, RuleState *states, uint8_t count, uint32_t now_ms);
+extern uint32_t rules_evaluate(const Rule *rules, RuleState *states, uint8_t count, int32_t rise_milliF, uint32_t now_ms);
+
+#endif /* RULES_H */
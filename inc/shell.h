@@ -0,0 +1,31 @@
+/*
+ * shell.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef SHELL_H
+#define SHELL_H
+
+#include <inttypes.h>
+#include "rules.h"
+#include "rate.h"
+#include "stats.h"
+
+#define SHELL_MAX_ARGS 6
+#define SHELL_PROMPT "> "
+
+typedef void (*ShellHandler)(int argc, char **argv);
+
+//one row of the command table
+typedef struct {
+	const char *name;
+	const char *usage;
+	ShellHandler handler;
+} ShellCommand;
+
+extern void shell_init(Rule *rules, RuleState *states, uint8_t count, RateTrip *trip, const RateEstimator *estimator, Stats *days);
+extern void shell_execute(char *line);
+
+#endif /* SHELL_H */
@@ -0,0 +1,48 @@
+/*
+ * stats.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <inttypes.h>
+
+//statistics constants
+#define STATS_BINS			16			//histogram bins, the end bins also count samples outside the range
+#define STATS_BIN_START		50000		//lower edge of the second bin, thousandths of a degree
+#define STATS_BIN_WIDTH		2000		//thousandths of a degree per bin
+#define STATS_THRESHOLDS	3			//temperatures with time above accumulated
+#define STATS_DAY_MS		86400000
+
+/*
+ * Running statistics of a temperature stream. Mean and variance come from
+ * integer sums of the samples' distance from the first sample, so they are
+ * exact over a day of samples without storing them.
+ */
+typedef struct {
+	uint32_t start_ms;					//time of the first sample
+	uint32_t last_ms;					//time of the latest sample
+	uint32_t count;
+	int32_t origin;						//first sample, thousandths of a degree
+	int64_t sum;						//sum of differences from origin
+	int64_t sum_sq;						//sum of squared differences from origin
+	int32_t min;
+	uint32_t min_ms;
+	int32_t max;
+	uint32_t max_ms;
+	int32_t thresholds[STATS_THRESHOLDS];
+	uint32_t above_ms[STATS_THRESHOLDS];	//time spent at or above each threshold
+	uint32_t bins[STATS_BINS];
+} Stats;
+
+extern void stats_init(Stats *stats, uint32_t now_ms);
+extern void stats_set_threshold(Stats *stats, uint8_t index, int32_t milliF);
+extern void stats_update(Stats *stats, int32_t milliF, uint32_t now_ms);
+extern int32_t stats_mean(const Stats *stats);
+extern int32_t stats_stddev(const Stats *stats);
+extern int32_t stats_bin_low(uint8_t bin);
+
+#endif /* STATS_H */
@@ -0,0 +1,77 @@
+/*
+ * system_clock.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef SYSTEM_CLOCK_H
+#define SYSTEM_CLOCK_H
+
+#include <inttypes.h>
+#include "reg.h"
+#include "flash.h"
+
+//RCC constants
+#define RCC_CR REG32(0x40023800)
+#define RCC_PLLCFGR REG32(0x40023804)
+#define RCC_CFGR REG32(0x40023808)
+#define RCC_APB1ENR REG32(0x40023840)
+#define RCC_CR_PLLON_F 24
+#define RCC_CR_PLLRDY_F 25
+#define RCC_PLLCFGR_PLLN_F 6
+#define RCC_PLLCFGR_PLLP_F 16
+#define RCC_PLLCFGR_PLLQ_F 24
+#define RCC_PLLCFGR_PLLR_F 28
+#define RCC_CFGR_SW_F 0
+#define RCC_CFGR_SWS_F 2
+#define RCC_CFGR_SW_PLL 2
+#define RCC_CFGR_HPRE_F 4
+#define RCC_CFGR_PPRE1_F 10
+#define RCC_CFGR_PPRE2_F 13
+#define PWR_RCCEN_F 28
+
+//PWR constants
+#define PWR_CR REG32(0x40007000)
+#define PWR_CSR REG32(0x40007004)
+#define PWR_CR_VOS_F 14
+#define PWR_CR_VOS_SCALE1 3
+#define PWR_CR_ODEN_F 16
+#define PWR_CR_ODSWEN_F 17
+#define PWR_CSR_ODRDY_F 16
+#define PWR_CSR_ODSWRDY_F 17
+
+//flash accelerator constants
+#define FLASH_ACR_LATENCY_F 0
+#define FLASH_ACR_PRFTEN_F 8
+#define FLASH_ACR_ICEN_F 9
+#define FLASH_ACR_ICRST_F 11
+
+/*
+ * Clock tree. The 16MHz HSI is divided to 2MHz for the PLL, multiplied to a
+ * 360MHz VCO and divided by 2 for a 180MHz system clock. APB1 is divided by 4
+ * (45MHz, timers 90MHz) and APB2 by 2 (90MHz, timers 180MHz), their maximums.
+ */
+#define HSI_VALUE			16000000
+#define CLOCK_PLLM			8
+#define CLOCK_PLLN			180
+#define CLOCK_PLLP			2
+#define CLOCK_PLLQ			8			//USB/SDIO clock, unused
+#define CLOCK_PLLR			2			//I2S/SPDIF clock, unused
+#define CLOCK_SYSCLK		(HSI_VALUE / CLOCK_PLLM * CLOCK_PLLN / CLOCK_PLLP)
+#define CLOCK_PPRE1_DIV4	5
+#define CLOCK_PPRE2_DIV2	4
+#define CLOCK_WAIT_STATES	5			//flash latency for 150-180MHz at 2.7-3.6V
+#define CLOCK_TIMEOUT		100000		//polls before giving up on the PLL and staying on HSI
+
+//core clock in Hz, the HSI value until SystemInit() has switched to the PLL
+extern uint32_t SystemCoreClock;
+
+extern void SystemInit();
+extern uint32_t clock_get_hclk();
+extern uint32_t clock_get_pclk1();
+extern uint32_t clock_get_pclk2();
+extern uint32_t clock_get_apb1_timer_clk();
+extern uint32_t clock_get_apb2_timer_clk();
+
+#endif /* SYSTEM_CLOCK_H */
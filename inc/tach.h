@@ -0,0 +1,91 @@
+/*
+ * tach.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef TACH_H
+#define TACH_H
+
+#include <inttypes.h>
+#include "reg.h"
+#include "gpio.h"
+#include "pwm.h"
+#include "nvic.h"
+#include "system_clock.h"
+
+//RCC constants
+#define RCC_APB1ENR REG32(0x40023840)
+#define TIM2_RCCEN_F 0
+
+//TIM2 constants(32 bit general purpose timer, APB1)
+#define TIM2_CR1	REG32(0x40000000)
+#define TIM2_DIER	REG32(0x4000000C)
+#define TIM2_SR		REG32(0x40000010)
+#define TIM2_EGR	REG32(0x40000014)
+#define TIM2_CCMR1	REG32(0x40000018)
+#define TIM2_CCER	REG32(0x40000020)
+#define TIM2_CNT	REG32(0x40000024)
+#define TIM2_PSC	REG32(0x40000028)
+#define TIM2_ARR	REG32(0x4000002C)
+#define TIM2_CCR1	REG32(0x40000034)
+
+//input capture fields
+#define TIM_CCMR1_CC1S_F	0
+#define TIM_CCMR1_IC1F_F	4
+#define TIM_CC1S_TI1		0b01
+#define TIM_IC1F_DTS32_N8	0b1111		//8 samples at the timer clock / 32, about 2.8us
+#define TIM_DIER_CC1IE_F	1
+#define TIM_SR_CC1IF_F		1
+#define TIM_SR_CC1OF_F		9
+#define TIM_CCER_CC1P_F		1
+
+//tach input, TIM2_CH1 on PA0, the fan's open collector output needs the pull-up
+#define TACH_PIN			0
+#define TACH_AF				1
+
+//tachometer constants
+#define TACH_TIMER_HZ		1000000		//capture resolution
+#define TACH_PULSES_PER_REV	2
+#define TACH_FILTER_LEN		5			//median of the last periods
+#define TACH_MAX_RPM		7500		//above the 5V fan's top speed, with margin
+#define TACH_MIN_PERIOD_US	(TACH_TIMER_HZ * 60 / (TACH_MAX_RPM * TACH_PULSES_PER_REV))	//4ms, shorter is noise
+#define TACH_IRQ_PRIORITY	3
+
+/*
+ * The fan is switched on its low side, so its tach output floats, and gives an
+ * edge every PWM cycle, while the gate is off. Measurements are taken in a
+ * window at the start of every TACH_WINDOW_PERIOD_US, during which the control
+ * loop holds the gate fully on. The capture and its interrupt are only armed
+ * from TACH_SETTLE_US into the window until it closes, so the floating edges
+ * never reach the core. The period is a power of two so the window phase
+ * survives the counter wrapping. A window fits one period at TACH_STALL_RPM
+ * and several at full speed.
+ */
+#define TACH_WINDOW_PERIOD_US	(1u << 20)	//about 1s
+#define TACH_WINDOW_US		80000
+#define TACH_SETTLE_US		2000		//control loop applies the hold within one update
+#define TACH_TIMEOUT_US		(TACH_WINDOW_PERIOD_US + TACH_WINDOW_US)	//a whole window without an edge reads 0 RPM
+
+//stall detection
+#define TACH_STALL_DUTY		300			//fan duty at which it must be turning
+#define TACH_STALL_RPM		500			//slower than this counts as stalled
+#define TACH_SPINUP_MS		3000		//time for the fan to start before it is checked
+#define TACH_STALL_MS		2000		//time below TACH_STALL_RPM before the fault is raised
+
+typedef struct {
+	uint32_t pulses;		//edges captured
+	uint32_t rejected;		//edges closer than TACH_MIN_PERIOD_US to the last
+	uint32_t masked;		//edges captured just after a window closed
+	uint32_t overcaptures;	//edges missed while a capture was pending
+} TachCounts;
+
+extern void tach_init();
+extern uint32_t tach_get_rpm();
+extern uint8_t tach_window();
+extern uint8_t tach_check_stall(uint16_t fan_duty, uint32_t now_ms);
+extern uint8_t tach_stalled();
+extern void tach_get_counts(TachCounts *counts);
+
+#endif /* TACH_H */
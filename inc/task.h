@@ -0,0 +1,34 @@
+/*
+ * task.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef TASK_H
+#define TASK_H
+
+#include <inttypes.h>
+#include "pt.h"
+#include "dwt.h"
+
+#define MAX_TASKS 8
+
+typedef char (*TaskFn)(PT *pt);
+
+//executor statistics
+typedef struct {
+	uint8_t tasks;			//registered tasks
+	uint8_t active;			//tasks started and not yet finished
+	uint32_t switches;		//protothread resumes
+	uint32_t max_cycles;	//longest single resume
+	uint32_t total_cycles;	//cycles spent in protothreads, wraps
+} TaskStats;
+
+extern int8_t task_add(TaskFn fn);
+extern void task_start(int8_t id);
+extern uint8_t task_active(int8_t id);
+extern uint8_t task_poll();
+extern void task_get_stats(TaskStats *stats);
+
+#endif /* TASK_H */
@@ -0,0 +1,53 @@
+/*
+ * telemetry.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <inttypes.h>
+
+/*
+ * Telemetry frame layout, all fields little endian:
+ * 		type(1) seq(2) time_ms(4) raw(2) temp_milliF(4) offset_milliF(4)
+ * 		duty[3](6) crc16(2)
+ * The frame is COBS encoded and sent between two zero bytes.
+ */
+#define TELEMETRY_TYPE_SAMPLE	0x01
+#define TELEMETRY_PAYLOAD_SIZE	23
+#define TELEMETRY_FRAME_SIZE	(TELEMETRY_PAYLOAD_SIZE + 2)
+#define TELEMETRY_WIRE_SIZE		(TELEMETRY_FRAME_SIZE + 1 + 2)	//COBS code byte and delimiters
+#define TELEMETRY_LOADS			3
+
+/*
+ * The stream is decimated: one frame is sent every TELEMETRY_PERIOD, holding
+ * the control loop's latest values, so one control update in ten reaches the
+ * host. Every update would be TELEMETRY_WIRE_SIZE bytes at CONTROL_RATE_HZ,
+ * 28000 bytes/s, over twice what the 115200 baud console carries, 11520
+ * bytes/s. At 100 Hz the stream takes about a quarter of the line and leaves
+ * room for console replies. The temperature is the loop's filtered value, with
+ * a time constant of 128 updates, so little is lost between frames. The raw
+ * ADC code is a single conversion and is not averaged.
+ */
+#define TELEMETRY_PERIOD		10		//milliseconds between frames, every tenth control update
+#define TELEMETRY_AT_BOOT		0		//stream from start up, otherwise use the shell
+
+typedef struct {
+	uint16_t seq;					//frame counter, wraps
+	uint32_t time_ms;				//time since start up
+	uint16_t raw;					//ADC code
+	int32_t temp_milliF;			//filtered temperature including offset
+	int32_t offset_milliF;			//user offset
+	uint16_t duty[TELEMETRY_LOADS];	//gate duty cycle per load, tenths of a percent
+} TelemetrySample;
+
+extern uint32_t telemetry_pack(const TelemetrySample *sample, uint8_t *wire);
+extern int telemetry_unpack(const uint8_t *encoded, uint32_t len, TelemetrySample *sample);
+extern void telemetry_enable(uint8_t enable);
+extern uint8_t telemetry_enabled();
+extern void telemetry_send();
+
+#endif /* TELEMETRY_H */
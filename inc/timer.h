@@ -10,16 +10,37 @@
 
 
 //SysTic constants
-#define STK_CTRL (volatile uint32_t*) 0xE000E010
-#define STK_LOAD (volatile uint32_t*) 0xE000E014
-#define STK_VAL (volatile uint32_t*) 0xE000E018
+#define STK_CTRL REG32(0xE000E010)
+#define STK_LOAD REG32(0xE000E014)
+#define STK_VAL REG32(0xE000E018)
 #define STK_ENABLE_F 0
 #define STK_CLKSOURCE_F 2
 #define STK_CNTFLAG_F 16
 
+//RCC constants
+#define RCC_APB1ENR REG32(0x40023840)
+#define TIM7_RCCEN_F 5
+
+//TIM7 constants(millisecond tick)
+#define TIM7_CR1 REG32(0x40001400)
+#define TIM7_DIER REG32(0x4000140C)
+#define TIM7_SR REG32(0x40001410)
+#define TIM7_PSC REG32(0x40001428)
+#define TIM7_ARR REG32(0x4000142C)
+#define TIM7_CEN_F 0
+#define TIM7_UIE_F 0
+#define TIM7_UIF_F 0
+#define TICK_IRQ_PRIORITY 2
+
 #include <inttypes.h>
+#include "reg.h"
+#include "nvic.h"
+#include "system_clock.h"
+#include "watchdog.h"
 
 extern void delay_ms(uint32_t t_ms);
 extern void delay_us(uint32_t t_us);
+extern void tick_init();
+extern uint32_t get_time_ms();
 
 #endif /* TIMER_H */
\ No newline at end of file
@@ -0,0 +1,91 @@
+/*
+ * trace.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <inttypes.h>
+#include "pt.h"
+#include "dwt.h"
+
+//trace buffer constants
+#define TRACE_SIZE			256			//records kept, a power of two
+#define TRACE_NO_TRIGGER	0xFFFF
+
+/*
+ * Trace point ids. The argument recorded with each is listed alongside.
+ */
+typedef enum {
+	TRACE_EVENT,		//event handler dispatched, once per run of back to back tasks events, arg: Event
+	TRACE_TEMP,			//temperature sampled, arg: tenths of a degree, signed
+	TRACE_KEY,			//key pressed, arg: ascii key
+	TRACE_LOADS,		//loads switched, arg: load bit mask
+	TRACE_RATE,			//rate of rise trip changed, arg: 1 when tripped
+	TRACE_FAN,			//fan control enabled or disabled, arg: 1 when enabled
+	TRACE_CONSOLE,		//console line received, in the USART2 interrupt
+	TRACE_STALL,		//fan stall detected or cleared, arg: 1 when stalled
+	NUM_TRACE_IDS
+} TraceId;
+
+//names in TraceId order, shared with the host decoder
+#define TRACE_NAMES	{"event", "temp", "key", "loads", "rate", "fan", "console", "stall"}
+
+/*
+ * One 8 byte record. The timestamp is the core cycle counter, so it wraps
+ * every 2^32 cycles and records are ordered by their position in the buffer.
+ */
+typedef struct {
+	uint32_t cycles;
+	uint16_t id;
+	uint16_t arg;
+} TraceRecord;
+
+typedef struct {
+	uint32_t records;		//records written since the buffer was armed
+	uint16_t trigger;		//id that freezes the buffer, TRACE_NO_TRIGGER if none
+	uint16_t post;			//records kept after the trigger
+	uint8_t triggered;		//trigger seen
+	uint8_t frozen;
+} TraceInfo;
+
+extern TraceRecord trace_buffer[TRACE_SIZE];
+extern volatile uint32_t trace_head;
+extern volatile uint8_t trace_frozen;
+extern volatile uint16_t trace_trigger;
+extern volatile uint16_t trace_countdown;
+
+extern void trace_fire(uint16_t id);
+extern void trace_arm(uint16_t trigger, uint16_t post);
+extern void trace_freeze();
+extern void trace_get_info(TraceInfo *info);
+extern PT_THREAD(trace_dump_pt(PT *pt));
+
+/*
+ * Records a trace point. The slot is claimed with one atomic increment, so it
+ * is safe from any interrupt or handler without disabling interrupts. Only a
+ * trigger match or a pending freeze leaves the inline path.
+ * Inputs:
+ * 		id - trace point id
+ * 		arg - 16 bit argument
+ * Outputs:
+ * 		none
+ */
+static inline void trace(TraceId id, uint16_t arg){
+	if(trace_frozen){
+		return;
+	}
+	uint32_t index = __atomic_fetch_add(&trace_head, 1, __ATOMIC_RELAXED);
+	TraceRecord *record = &trace_buffer[index % TRACE_SIZE];
+	record->cycles = DWT_CYCLES();
+	record->id = id;
+	record->arg = arg;
+	if(id == trace_trigger || trace_countdown != 0){
+		trace_fire(id);
+	}
+}
+
+#endif /* TRACE_H */
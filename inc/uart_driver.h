@@ -9,36 +9,95 @@
 #define UART_DRIVER_H_
 
 #include <inttypes.h>
+#include "reg.h"
+#include "nvic.h"
 
 // RCC registers
-#define RCC_APB1ENR (volatile uint32_t*) 0x40023840
-#define RCC_AHB1ENR (volatile uint32_t*) 0x40023830
+#define RCC_APB1ENR REG32(0x40023840)
+#define RCC_AHB1ENR REG32(0x40023830)
 
 #define GPIOAEN 0		// GPIOA Enable is bit 0 in RCC_APB1LPENR
 #define USART2EN 17  // USART2 enable is bit 17 in RCC_AHB1LPENR
+#define DMA1EN 21	// DMA1 enable is bit 21 in RCC_AHB1ENR
 
 // GPIOA registers
-#define GPIOA_MODER (volatile uint32_t*) 0x40020000
-#define GPIOA_AFRL  (volatile uint32_t*) 0x40020020
-#define USART_SR    (volatile uint32_t*) 0x40004400
-#define USART_DR    (volatile uint32_t*) 0x40004404
-#define USART_BRR   (volatile uint32_t*) 0x40004408
-#define USART_CR1   (volatile uint32_t*) 0x4000440c
-#define USART_CR2   (volatile uint32_t*) 0x40004410
-#define USART_CR3   (volatile uint32_t*) 0x40004414
+#define GPIOA_MODER REG32(0x40020000)
+#define GPIOA_AFRL  REG32(0x40020020)
+#define USART_SR    REG32(0x40004400)
+#define USART_DR    REG32(0x40004404)
+#define USART_BRR   REG32(0x40004408)
+#define USART_CR1   REG32(0x4000440c)
+#define USART_CR2   REG32(0x40004410)
+#define USART_CR3   REG32(0x40004414)
+
+#define GPIOA_AFRH  REG32(0x40020024)
+
+// DMA1 stream 6 registers(USART2_TX is channel 4)
+#define DMA1_HISR   REG32(0x40026004)
+#define DMA1_HIFCR  REG32(0x4002600C)
+#define DMA1_S6CR   REG32(0x400260A0)
+#define DMA1_S6NDTR REG32(0x400260A4)
+#define DMA1_S6PAR  REG32(0x400260A8)
+#define DMA1_S6M0AR REG32(0x400260AC)
 
 // CR1 bits
 #define UE 13 //UART enable
+#define RXNEIE 5 // Receive interrupt enable
 #define TE 3  // Transmitter enable
 #define RE 2  // Receiver enable
 
+// CR3 bits
+#define DMAT 7 // DMA enable transmitter
+#define EIE 0  // Error interrupt enable
+
 // Status register bits
 #define TXE 7  // Transmit register empty
 #define RXNE 5  // Receive register is not empty..char received
+#define ORE 3  // Overrun error
+#define NF 2   // Noise detected
+#define FE 1   // Framing error
+
+// DMA stream 6 bits
+#define DMA_CHSEL 25	// channel select, 3 bits
+#define DMA_MINC 10		// memory increment
+#define DMA_DIR 6		// direction, 2 bits, 01 is memory to peripheral
+#define DMA_TCIE 4		// transfer complete interrupt enable
+#define DMA_TEIE 2		// transfer error interrupt enable
+#define DMA_EN 0		// stream enable
+#define DMA_S6_FLAGS (0x3D << 16)	// all stream 6 flags in HISR/HIFCR
+#define DMA_TCIF6 21	// stream 6 transfer complete
+
+// buffer sizes, must be powers of 2
+#define USART2_TX_SIZE 2048
+#define USART2_RX_SIZE 128
+#define USART2_LINE_SIZE 64		// longest line, including the terminator
+#define USART2_LINES 4			// line slots, one is always the line being typed
+#define USART2_IRQ_PRIORITY 4	// below the control loop, tick and tach, console work never delays them
+
+// receive error counters
+typedef struct {
+	uint32_t overrun;		// bytes lost in the USART before the interrupt ran
+	uint32_t framing;		// bytes received with a bad stop bit
+	uint32_t noise;			// bytes received with noise detected
+	uint32_t long_lines;	// characters dropped because a line was too long
+	uint32_t lost_lines;	// complete lines dropped because none were read
+} UartErrors;
+
+typedef void (*UartLineCallback)();
 
 // Function prototypes
 extern void init_usart2(uint32_t baud, uint32_t sysclk);
 extern char usart2_getch();
 extern void usart2_putch(char c);
+extern int usart2_write(const char *data, int len);
+extern int usart2_rx_count();
+extern uint32_t usart2_tx_dropped();
+extern uint32_t usart2_tx_free();
+extern int usart2_readline(char *buf, int size);
+extern int usart2_print_string(const char *pointer);
+extern int usart2_print_num(int32_t num);
+extern void usart2_set_line_callback(UartLineCallback callback);
+extern void usart2_set_echo(uint8_t echo);
+extern void usart2_get_errors(UartErrors *errors);
 
 #endif /* UART_DRIVER_H_ */
@@ -0,0 +1,68 @@
+/*
+ * watchdog.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <inttypes.h>
+#include "reg.h"
+
+//independent watchdog constants
+#define IWDG_KR		REG32(0x40003000)
+#define IWDG_PR		REG32(0x40003004)
+#define IWDG_RLR	REG32(0x40003008)
+#define IWDG_SR		REG32(0x4000300C)
+#define IWDG_KEY_START	0xCCCC
+#define IWDG_KEY_UNLOCK	0x5555
+#define IWDG_KEY_RELOAD	0xAAAA
+#define IWDG_PR_DIV128	5
+#define IWDG_SR_PVU_F	0
+#define IWDG_SR_RVU_F	1
+
+//stop the watchdog while the core is halted by a debugger
+#define DBGMCU_APB1_FZ	REG32(0xE0042008)
+#define DBG_IWDG_STOP_F	12
+
+/*
+ * The LSI runs at a nominal 32kHz, divided by 128 the counter steps every 4ms.
+ * The timeout is 4s nominal and about 2.7s with the fastest LSI, which is longer
+ * than a worst case sector erase. The core stalls on instruction fetch during an
+ * erase, so nothing can check in or reload the watchdog until it finishes.
+ */
+#define WATCHDOG_RELOAD		1000
+#define WATCHDOG_PERIOD		100		//milliseconds between liveness checks
+
+/*
+ * Supervised activities. Each must check in at least once within its deadline,
+ * or the watchdog is no longer kicked and resets the processor.
+ */
+typedef enum {
+	WATCHDOG_SAMPLE,		//sample event handler
+	WATCHDOG_CONTROL,		//control loop collecting ADC conversions
+	WATCHDOG_DISPLAY,		//LCD refreshes completing
+	WATCHDOG_INPUT,			//keypad scans
+	NUM_WATCHDOG_TASKS
+} WatchdogTask;
+
+//deadlines in milliseconds, in WatchdogTask order
+#define WATCHDOG_DEADLINES	{1000, 100, 2000, 500}
+
+//periods since each task last checked in, cleared by WATCHDOG_CHECKIN
+extern volatile uint8_t watchdog_age[NUM_WATCHDOG_TASKS];
+
+/*
+ * Records that a task is alive. A single byte store, so it is safe from any
+ * interrupt or handler.
+ */
+#define WATCHDOG_CHECKIN(task)	(watchdog_age[(task)] = 0)
+
+extern void watchdog_init();
+extern void watchdog_tick();
+extern void watchdog_reload();
+extern int8_t watchdog_late();
+
+#endif /* WATCHDOG_H */
@@ -0,0 +1,996 @@
+/*
+ * periph.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * Register level models of the peripherals the firmware drives. Each model
+ * works on the raw register slots, so it sees exactly what the firmware wrote.
+ * Writes are found by periph_sync(), which compares the registers that have
+ * side effects against their last known values on every access. Reads are
+ * prepared by periph_access() just before the firmware reads the slot. Events
+ * that happen at a later time, such as a timer update or the end of a DMA
+ * transfer, are run by periph_advance() once virtual time reaches them.
+ *
+ * Only what this firmware uses is modelled: the clock tree ready flags, flash
+ * erase, SysTick, DWT, TIM6 and TIM7, the ADC, the keypad matrix and HD44780
+ * LCD on GPIO B and C, USART2 with DMA1 stream 6, the NVIC enables, the IWDG,
+ * the load gates on TIM1 and TIM3 and the fan tach captured by TIM2.
+ */
+
+#include <string.h>
+
+#include "sim.h"
+#include "system_clock.h"
+
+//register addresses, see the firmware headers
+#define A_RCC_CR		0x40023800
+#define A_RCC_CFGR		0x40023808
+#define A_RCC_CSR		0x40023874
+#define A_PWR_CR		0x40007000
+#define A_PWR_CSR		0x40007004
+#define A_FLASH_KEYR	0x40023C04
+#define A_FLASH_SR		0x40023C0C
+#define A_FLASH_CR		0x40023C10
+#define A_STK_CTRL		0xE000E010
+#define A_STK_LOAD		0xE000E014
+#define A_DWT_CYCCNT	0xE0001004
+#define A_NVIC_ISER0	0xE000E100
+#define A_NVIC_ICER0	0xE000E180
+#define A_TIM6			0x40001000
+#define A_TIM7			0x40001400
+#define A_TIM1			0x40010000
+#define A_TIM3			0x40000400
+#define A_TIM2			0x40000000
+#define A_ADC_SR		0x40012000
+#define A_ADC_CR2		0x40012008
+#define A_ADC_DR		0x4001204C
+#define A_GPIOA			0x40020000
+#define A_GPIOB			0x40020400
+#define A_GPIOC			0x40020800
+#define A_USART_SR		0x40004400
+#define A_USART_DR		0x40004404
+#define A_USART_BRR		0x40004408
+#define A_USART_CR1		0x4000440C
+#define A_DMA1_HISR		0x40026004
+#define A_DMA1_HIFCR	0x4002600C
+#define A_DMA1_S6CR		0x400260A0
+#define A_DMA1_S6NDTR	0x400260A4
+#define A_DMA1_S6M0AR	0x400260AC
+#define A_IWDG_KR		0x40003000
+#define A_IWDG_PR		0x40003004
+#define A_IWDG_RLR		0x40003008
+#define A_SCB_AIRCR		0xE000ED0C
+
+//slot of a register, the models only use mapped addresses
+#define R(addr)	((addr) >= SIM_PPB_BASE ? &sim_ppb_regs[((addr) - SIM_PPB_BASE) / 4] \
+						: &sim_periph_regs[((addr) - SIM_PERIPH_BASE) / 4])
+
+//register offsets within a timer and a GPIO port
+#define TIM_CR1		0x00
+#define TIM_DIER	0x0C
+#define TIM_SR		0x10
+#define TIM_CCER	0x20
+#define TIM_CNT		0x24
+#define TIM_PSC		0x28
+#define TIM_ARR		0x2C
+#define TIM_CCR1	0x34
+#define TIM_CCR2	0x38
+#define GPIO_MODER	0x00
+#define GPIO_IDR	0x10
+#define GPIO_ODR	0x14
+
+//timing of the modelled parts
+#define SIM_ADC_CYCLES		200			//sampling and conversion at the ADC clock
+#define SIM_ERASE_MS		1000		//128KB sector erase, typical
+#define SIM_LCD_CMD_US		37
+#define SIM_LCD_CLEAR_US	1520
+#define SIM_LCD_IDLE_MS		10			//quiet time before the LCD contents are shown
+#define SIM_LSI_HZ			32000
+#define SIM_GATE_LOG		64			//gate transitions kept for the report
+#define SIM_FAN_RPM			3000		//speed at full duty, two tach pulses per revolution
+#define SIM_FAN_MIN_DUTY	20			//percent below which the fan does not turn
+#define SIM_FAN_SPINUP_MS	1000
+
+#define FLASH_KEY1	0x45670123
+#define FLASH_KEY2	0xCDEF89AB
+
+#define KEYPAD_KEYS	"123A456B789C*0#D"
+
+typedef struct {
+	uint32_t base;
+	int irq;
+	uint8_t running;
+	uint64_t period;
+	uint64_t next;
+} BasicTimer;
+
+typedef struct {
+	uint64_t time;
+	uint8_t gates;
+} GateChange;
+
+static const char *gate_names[] = {"led", "fan", "siren"};
+#define NUM_GATES 3
+
+static uint32_t shadow_stk_ctrl;
+static uint64_t stk_start;
+
+static uint32_t dwt_value;
+static uint64_t dwt_base;
+
+static uint32_t nvic_enabled[3];
+
+static BasicTimer timers[] = {
+	{A_TIM6, 54, 0, 0, 0},
+	{A_TIM7, 55, 0, 0, 0},
+};
+#define NUM_TIMERS (sizeof(timers) / sizeof(timers[0]))
+
+static uint8_t adc_busy;
+static uint64_t adc_done;
+static int adc_noise;
+static uint32_t noise_state = 1;
+
+static int key_pressed = -1;
+
+static uint32_t shadow_b_odr;
+static uint8_t lcd_high_nibble;
+static uint8_t lcd_have_nibble;
+static uint8_t lcd_address;
+static char lcd_ram[2][40];
+static char lcd_shown[2][17];
+static uint64_t lcd_busy_until;
+static uint64_t lcd_last_write;
+static uint8_t lcd_dirty;
+static uint8_t lcd_stuck;
+static uint8_t lcd_in_transaction;
+static uint64_t lcd_transaction_start;
+static struct {
+	uint64_t commands;
+	uint64_t data;
+	uint64_t busy_writes;
+	uint64_t transactions;
+	uint64_t transaction_total;
+	uint64_t transaction_max;
+} lcd_stats;
+
+static uint32_t shadow_s6cr;
+static uint8_t tx_active;
+static uint64_t tx_done;
+static char tx_line[128];
+static int tx_len;
+static uint8_t tx_binary;
+static uint64_t tx_bytes, tx_frames;
+
+static char rx_queue[1024];
+static int rx_head, rx_tail;
+static uint64_t rx_next;
+static uint64_t rx_bytes, rx_overruns;
+
+static uint8_t flash_key_stage;
+static uint64_t flash_erases;
+
+static uint8_t iwdg_running;
+static uint64_t iwdg_expire;
+
+static uint8_t tim2_running;
+static uint32_t tim2_sr;
+static uint64_t tim2_start;
+static uint64_t tim2_tick_cycles;
+static uint8_t fan_stalled;
+static uint64_t fan_on_since;
+static uint64_t tach_next = SIM_FOREVER;
+static uint64_t tach_pulses;
+static uint8_t tach_floating;
+static uint64_t float_next = SIM_FOREVER;
+static uint64_t float_edges;
+
+static uint8_t gates;
+static GateChange gate_log[SIM_GATE_LOG];
+static uint64_t gate_changes;
+
+static uint32_t apb1_divider();
+static void sync_timer(BasicTimer *timer);
+static void advance_timer(BasicTimer *timer);
+static uint32_t adc_code();
+static uint32_t gpioc_idr();
+static void lcd_latch(uint8_t rs, uint8_t nibble);
+static void lcd_write(uint8_t rs, uint8_t value);
+static void lcd_show();
+static void uart_tx_byte(char c);
+static void sync_gates();
+static uint32_t timer_cycles_per_tick();
+static uint32_t tim2_count(uint64_t when);
+static uint32_t fan_rpm();
+static void tach_edge(uint64_t when);
+
+/*
+ * Puts the registers in their reset state. The reset flags say power on, as
+ * for a board that was just plugged in.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void periph_init(){
+	*R(A_RCC_CR) = 0x00000083;
+	*R(A_RCC_CSR) = 0x0C000000;
+	*R(A_FLASH_CR) = 0x80000000;
+	*R(A_USART_SR) = 0x000000C0;
+	*R(A_IWDG_RLR) = 0xFFF;
+	memset(lcd_ram, ' ', sizeof(lcd_ram));
+}
+
+/*
+ * Finds the writes made since the previous register access and acts on them.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void periph_sync(){
+	//SysTick, the count flag is read only
+	uint32_t ctrl = *R(A_STK_CTRL) & ~(1u<<16);
+	if((ctrl & 1) && !(shadow_stk_ctrl & 1)){
+		stk_start = sim_cycles;
+	}
+	shadow_stk_ctrl = ctrl;
+
+	//DWT cycle counter written
+	if(*R(A_DWT_CYCCNT) != dwt_value){
+		dwt_value = *R(A_DWT_CYCCNT);
+		dwt_base = sim_cycles - dwt_value;
+	}
+
+	//NVIC set and clear enable registers
+	for(int i = 0; i < 3; i++){
+		volatile uint32_t *iser = R(A_NVIC_ISER0 + 4*i);
+		volatile uint32_t *icer = R(A_NVIC_ICER0 + 4*i);
+		if(*icer != 0){
+			nvic_enabled[i] &= ~*icer;
+			*icer = 0;
+		}
+		nvic_enabled[i] |= *iser;
+		*iser = nvic_enabled[i];
+	}
+
+	for(unsigned int i = 0; i < NUM_TIMERS; i++){
+		sync_timer(&timers[i]);
+	}
+
+	//TIM2 counts from its start at the prescaled timer clock
+	uint8_t tim2_enabled = *R(A_TIM2 + TIM_CR1) & 1;
+	if(tim2_enabled && !tim2_running){
+		tim2_start = sim_cycles;
+		tim2_tick_cycles = (uint64_t)timer_cycles_per_tick() * (*R(A_TIM2 + TIM_PSC) + 1);
+	}
+	tim2_running = tim2_enabled;
+	volatile uint32_t *tim2_sr_slot = R(A_TIM2 + TIM_SR);
+	if(*tim2_sr_slot != tim2_sr){
+		tim2_sr &= *tim2_sr_slot;		//flags are cleared by writing 0, writing 1 has no effect
+		*tim2_sr_slot = tim2_sr;
+	}
+
+	//ADC software start
+	volatile uint32_t *cr2 = R(A_ADC_CR2);
+	if(*cr2 & (1u<<30)){
+		*cr2 &= ~(1u<<30);
+		adc_busy = 1;
+		adc_done = sim_cycles + SIM_ADC_CYCLES;
+	}
+
+	//LCD, data is latched on the falling edge of E while writing
+	uint32_t b_odr = *R(A_GPIOB + GPIO_ODR);
+	if(b_odr != shadow_b_odr){
+		if(b_odr & 2){
+			lcd_have_nibble = 0;
+		}else if((shadow_b_odr & 4) && !(b_odr & 4)){
+			lcd_latch(b_odr & 1, (*R(A_GPIOC + GPIO_ODR) >> 8) & 0xF);
+		}
+		shadow_b_odr = b_odr;
+	}
+
+	//DMA1 stream 6 enabled, the bytes go out at the baud rate
+	uint32_t s6cr = *R(A_DMA1_S6CR);
+	if((s6cr & 1) && !(shadow_s6cr & 1)){
+		uint32_t count = *R(A_DMA1_S6NDTR) & 0xFFFF;
+		const char *data = (const char*)(uintptr_t)*R(A_DMA1_S6M0AR);
+		for(uint32_t i = 0; i < count; i++){
+			uart_tx_byte(data[i]);
+		}
+		tx_active = 1;
+		tx_done = sim_cycles + (uint64_t)count * 10 * *R(A_USART_BRR) * apb1_divider();
+	}
+	shadow_s6cr = s6cr;
+	volatile uint32_t *hifcr = R(A_DMA1_HIFCR);
+	if(*hifcr != 0){
+		*R(A_DMA1_HISR) &= ~*hifcr;
+		*hifcr = 0;
+	}
+
+	//flash unlock and erase, the core stalls for the erase
+	volatile uint32_t *keyr = R(A_FLASH_KEYR);
+	volatile uint32_t *flash_cr = R(A_FLASH_CR);
+	if(*keyr != 0){
+		if(*keyr == FLASH_KEY1){
+			flash_key_stage = 1;
+		}else if(*keyr == FLASH_KEY2 && flash_key_stage == 1){
+			*flash_cr &= ~(1u<<31);
+			flash_key_stage = 0;
+		}else{
+			flash_key_stage = 0;
+		}
+		*keyr = 0;
+	}
+	if(*flash_cr & (1u<<16)){
+		*flash_cr &= ~(1u<<16);
+		uint32_t sector = (*flash_cr >> 3) & 0xF;
+		if((*flash_cr & (1u<<31)) || !(*flash_cr & 2)){
+			sim_log("flash start without an unlocked sector erase, ignored");
+		}else if(sector < 4 || sector > 7){
+			sim_log("flash erase of program sector %u refused", sector);
+		}else{
+			//sector 4 is 64KB, 5 to 7 are 128KB
+			uint32_t offset = sector == 4 ? 0x10000 : 0x20000*(sector-4);
+			memset((void*)(uintptr_t)(SIM_FLASH_BASE + offset), 0xFF, sector == 4 ? 0x10000 : 0x20000);
+			flash_erases++;
+			sim_log("flash erase sector %u", sector);
+			sim_cycles += sim_ms_to_cycles(SIM_ERASE_MS);
+		}
+	}
+
+	//independent watchdog keys
+	volatile uint32_t *kr = R(A_IWDG_KR);
+	if(*kr == 0xCCCC || (*kr == 0xAAAA && iwdg_running)){
+		uint32_t prescaler = 4u << (*R(A_IWDG_PR) & 7);
+		uint32_t reload = (*R(A_IWDG_RLR) & 0xFFF) + 1;
+		iwdg_running = 1;
+		iwdg_expire = sim_cycles + (uint64_t)reload * prescaler * SystemCoreClock / SIM_LSI_HZ;
+	}
+	*kr = 0;
+
+	//reset flags cleared
+	volatile uint32_t *csr = R(A_RCC_CSR);
+	if(*csr & (1u<<24)){
+		*csr &= 0x00FFFFFF;
+	}
+
+	//software reset
+	if((*R(A_SCB_AIRCR) >> 16) == 0x05FA){
+		sim_log("system reset requested");
+		sim_finish(4);
+	}
+
+	sync_gates();
+}
+
+/*
+ * Prepares a register the firmware is about to access. Status registers are
+ * brought up to date and reads with side effects act on the model.
+ * Inputs:
+ * 		addr - register address
+ * 		slot - the register's slot
+ * Outputs:
+ * 		none
+ */
+void periph_access(uint32_t addr, volatile uint32_t *slot){
+	switch(addr){
+		case A_RCC_CR:{
+			//ready follows on for HSI, HSE and the PLL
+			uint32_t on = *slot & ((1u<<0) | (1u<<16) | (1u<<24));
+			*slot = (*slot & ~((1u<<1) | (1u<<17) | (1u<<25))) | (on << 1);
+			break;
+		}
+		case A_RCC_CFGR:
+			*slot = (*slot & ~(3u<<2)) | ((*slot & 3) << 2);
+			break;
+		case A_PWR_CSR:{
+			uint32_t pwr_cr = *R(A_PWR_CR);
+			*slot = (1u<<14) | (pwr_cr & ((1u<<16) | (1u<<17)));
+			break;
+		}
+		case A_FLASH_SR:
+			*slot = 0;
+			break;
+		case A_STK_CTRL:
+			//a poll of the count flag waits for the wrap
+			if(*slot & 1){
+				uint64_t period = (*R(A_STK_LOAD) & 0xFFFFFF) + 1;
+				if(sim_cycles < stk_start + period){
+					sim_skip_to(stk_start + period);
+				}
+				if(sim_cycles >= stk_start + period){
+					stk_start += period * ((sim_cycles - stk_start) / period);
+					*slot |= 1u<<16;
+				}else{
+					*slot &= ~(1u<<16);
+				}
+			}
+			break;
+		case A_DWT_CYCCNT:
+			dwt_value = (uint32_t)(sim_cycles - dwt_base);
+			*slot = dwt_value;
+			break;
+		case A_ADC_DR:
+			*R(A_ADC_SR) &= ~(1u<<1);
+			break;
+		case A_TIM2 + TIM_CNT:
+			*slot = tim2_count(sim_cycles);
+			break;
+		case A_TIM2 + TIM_CCR1:
+			tim2_sr &= ~(1u<<1);
+			*R(A_TIM2 + TIM_SR) = tim2_sr;
+			break;
+		case A_GPIOA + GPIO_IDR:
+			*slot = *R(A_GPIOA + GPIO_ODR);
+			break;
+		case A_GPIOB + GPIO_IDR:
+			*slot = *R(A_GPIOB + GPIO_ODR);
+			break;
+		case A_GPIOC + GPIO_IDR:
+			*slot = gpioc_idr();
+			break;
+		case A_USART_DR:
+			*R(A_USART_SR) &= ~((1u<<5) | (1u<<3));
+			break;
+	}
+}
+
+/*
+ * Runs the events that are due at the current virtual time.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void periph_advance(){
+	for(unsigned int i = 0; i < NUM_TIMERS; i++){
+		advance_timer(&timers[i]);
+	}
+
+	if(adc_busy && sim_cycles >= adc_done){
+		adc_busy = 0;
+		*R(A_ADC_DR) = adc_code();
+		*R(A_ADC_SR) |= 1u<<1;
+	}
+
+	if(tx_active && sim_cycles >= tx_done){
+		tx_active = 0;
+		volatile uint32_t *s6cr = R(A_DMA1_S6CR);
+		*s6cr &= ~1u;
+		shadow_s6cr = *s6cr;
+		*R(A_DMA1_S6NDTR) = 0;
+		*R(A_DMA1_HISR) |= 1u<<21;
+		if(*s6cr & (1u<<4)){
+			sim_pend(17, tx_done);
+		}
+	}
+
+	//input waits for the receiver to be enabled
+	uint32_t brr = *R(A_USART_BRR);
+	uint32_t receiving = (1u<<13) | (1u<<2);
+	if(rx_head != rx_tail && (*R(A_USART_CR1) & receiving) == receiving && sim_cycles >= rx_next){
+		volatile uint32_t *sr = R(A_USART_SR);
+		if(*sr & (1u<<5)){
+			*sr |= 1u<<3;
+			rx_overruns++;
+		}
+		*R(A_USART_DR) = (uint8_t)rx_queue[rx_tail];
+		rx_tail = (rx_tail + 1) % sizeof(rx_queue);
+		rx_bytes++;
+		*sr |= 1u<<5;
+		if(*R(A_USART_CR1) & (1u<<5)){
+			sim_pend(38, sim_cycles);
+		}
+		rx_next = sim_cycles + (uint64_t)10 * brr * apb1_divider();
+	}
+
+	if(lcd_dirty && sim_cycles >= lcd_last_write + sim_ms_to_cycles(SIM_LCD_IDLE_MS)){
+		lcd_show();
+	}
+
+	//tach pulses at the current fan speed, the next one is timed from the last
+	uint32_t rpm = fan_rpm();
+	if(rpm == 0){
+		tach_next = SIM_FOREVER;
+	}else{
+		uint64_t period = (uint64_t)SystemCoreClock * 60 / (rpm * 2);
+		if(tach_next == SIM_FOREVER){
+			tach_next = sim_cycles + period;
+		}
+		while(sim_cycles >= tach_next){
+			tach_pulses++;
+			tach_edge(tach_next);
+			tach_next += period;
+		}
+	}
+
+	//a floating tach gives an edge each PWM cycle while the fan gate switches,
+	//TIM1 counts at the core clock
+	uint32_t compare = *R(A_TIM1 + TIM_CCR1) & 0xFFFF;
+	uint32_t top = (*R(A_TIM1 + TIM_ARR) & 0xFFFF) + 1;
+	if(tach_floating && (gates & 2) && compare < top){
+		uint64_t period = (uint64_t)((*R(A_TIM1 + TIM_PSC) & 0xFFFF) + 1) * top;
+		if(float_next == SIM_FOREVER){
+			float_next = sim_cycles + period;
+		}
+		while(sim_cycles >= float_next){
+			float_edges++;
+			tach_edge(float_next);
+			float_next += period;
+		}
+	}else{
+		float_next = SIM_FOREVER;
+	}
+
+	if(iwdg_running && sim_cycles >= iwdg_expire){
+		sim_log("watchdog reset");
+		sim_finish(3);
+	}
+}
+
+/*
+ * Returns the virtual time of the next model event, for WFI.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		virtual time, SIM_FOREVER if nothing is scheduled
+ */
+uint64_t periph_next_event(){
+	uint64_t next = SIM_FOREVER;
+	#define EARLIER(when)	do{ if((when) < next) next = (when); }while(0)
+	for(unsigned int i = 0; i < NUM_TIMERS; i++){
+		if(timers[i].running){
+			EARLIER(timers[i].next);
+		}
+	}
+	if(adc_busy){
+		EARLIER(adc_done);
+	}
+	if(tx_active){
+		EARLIER(tx_done);
+	}
+	if(rx_head != rx_tail){
+		EARLIER(rx_next);
+	}
+	if(lcd_dirty){
+		EARLIER(lcd_last_write + sim_ms_to_cycles(SIM_LCD_IDLE_MS));
+	}
+	if(iwdg_running){
+		EARLIER(iwdg_expire);
+	}
+	EARLIER(tach_next);
+	EARLIER(float_next);
+	uint64_t spun_up = fan_on_since + sim_ms_to_cycles(SIM_FAN_SPINUP_MS);
+	if((gates & 2) && !fan_stalled && spun_up > sim_cycles){
+		EARLIER(spun_up);
+	}
+	#undef EARLIER
+	return next;
+}
+
+/*
+ * Presses a key on the keypad, or releases it.
+ * Inputs:
+ * 		key - key legend, 0 to release
+ * Outputs:
+ * 		none
+ */
+void periph_set_key(char key){
+	const char *found = key ? strchr(KEYPAD_KEYS, key) : 0;
+	key_pressed = found ? (int)(found - KEYPAD_KEYS) : -1;
+}
+
+/*
+ * Sets the amplitude of the noise added to each ADC conversion.
+ * Inputs:
+ * 		lsb - largest error in ADC codes, 0 for none
+ * Outputs:
+ * 		none
+ */
+void periph_set_noise(int lsb){
+	adc_noise = lsb;
+}
+
+/*
+ * Queues text to arrive on the console, followed by a carriage return.
+ * Inputs:
+ * 		text - line to type
+ * Outputs:
+ * 		none
+ */
+void periph_uart_input(const char *text){
+	for(const char *c = text; ; c++){
+		char next = *c ? *c : '\r';
+		int head = (rx_head + 1) % sizeof(rx_queue);
+		if(head == rx_tail){
+			break;
+		}
+		if(rx_head == rx_tail && rx_next < sim_cycles){
+			rx_next = sim_cycles;
+		}
+		rx_queue[rx_head] = next;
+		rx_head = head;
+		if(*c == '\0'){
+			break;
+		}
+	}
+}
+
+/*
+ * Makes the LCD report busy forever, or behave again.
+ * Inputs:
+ * 		stuck - 1 to hang the LCD controller
+ * Outputs:
+ * 		none
+ */
+void periph_lcd_stuck(int stuck){
+	lcd_stuck = stuck;
+}
+
+/*
+ * Seizes the fan, so it stops turning whatever its gate does, or frees it.
+ * Inputs:
+ * 		stalled - 1 to stop the fan
+ * Outputs:
+ * 		none
+ */
+void periph_fan_stalled(int stalled){
+	fan_stalled = stalled;
+}
+
+/*
+ * Leaves the tach output floating while the fan gate is off, as on the board
+ * where the fan is switched on its low side, or ties it to the fan.
+ * Inputs:
+ * 		floating - 1 for an edge every PWM cycle the gate switches in
+ * Outputs:
+ * 		none
+ */
+void periph_tach_floating(int floating){
+	tach_floating = floating;
+}
+
+/*
+ * Shows what is still buffered when the run ends.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void periph_finish(){
+	periph_sync();
+	if(tx_len > 0 && !tx_binary){
+		tx_line[tx_len] = '\0';
+		sim_log("uart| %s", tx_line);
+	}
+	tx_len = 0;
+	if(lcd_dirty){
+		lcd_show();
+	}
+}
+
+/*
+ * Writes the model statistics: LCD transactions, console traffic, flash
+ * erases and every load gate transition.
+ */
+void periph_report(FILE *out){
+	fprintf(out, "# lcd %llu commands, %llu characters, %llu writes while busy\n",
+			(unsigned long long)lcd_stats.commands, (unsigned long long)lcd_stats.data,
+			(unsigned long long)lcd_stats.busy_writes);
+	if(lcd_stats.transactions > 0){
+		fprintf(out, "# lcd transactions %llu, avg %.1f us, max %.1f us\n",
+				(unsigned long long)lcd_stats.transactions,
+				sim_cycles_to_ms(lcd_stats.transaction_total / lcd_stats.transactions) * 1000,
+				sim_cycles_to_ms(lcd_stats.transaction_max) * 1000);
+	}
+	fprintf(out, "# uart tx %llu bytes, %llu frames, rx %llu bytes, %llu overruns\n",
+			(unsigned long long)tx_bytes, (unsigned long long)tx_frames,
+			(unsigned long long)rx_bytes, (unsigned long long)rx_overruns);
+	fprintf(out, "# flash %llu sector erases\n", (unsigned long long)flash_erases);
+	fprintf(out, "# tach %llu pulses, %llu floating edges\n",
+			(unsigned long long)tach_pulses, (unsigned long long)float_edges);
+	fprintf(out, "# gates %llu changes\n", (unsigned long long)gate_changes);
+	for(uint64_t i = 0; i < gate_changes && i < SIM_GATE_LOG; i++){
+		fprintf(out, "#   %10.3f ms", sim_cycles_to_ms(gate_log[i].time));
+		for(int g = 0; g < NUM_GATES; g++){
+			fprintf(out, " %s=%d", gate_names[g], (gate_log[i].gates >> g) & 1);
+		}
+		fprintf(out, "\n");
+	}
+}
+
+/*
+ * Returns core cycles per APB1 clock, the USART baud rate and the timers are
+ * derived from it.
+ */
+static uint32_t apb1_divider(){
+	uint32_t ppre = (*R(A_RCC_CFGR) >> RCC_CFGR_PPRE1_F) & 7;
+	return (ppre & 4) ? 2u << (ppre & 3) : 1;
+}
+
+/*
+ * Returns core cycles per tick of the APB1 timer clock, which runs at twice a
+ * divided APB1.
+ */
+static uint32_t timer_cycles_per_tick(){
+	uint32_t divider = apb1_divider();
+	return divider == 1 ? 1 : divider / 2;
+}
+
+/*
+ * Starts or stops a basic timer on a change of its counter enable. The period is
+ * fixed when the counter starts.
+ */
+static void sync_timer(BasicTimer *timer){
+	uint8_t enabled = *R(timer->base + TIM_CR1) & 1;
+	if(enabled && !timer->running){
+		timer->period = (uint64_t)((*R(timer->base + TIM_PSC) & 0xFFFF) + 1)
+				* ((*R(timer->base + TIM_ARR) & 0xFFFF) + 1) * timer_cycles_per_tick();
+		timer->next = sim_cycles + timer->period;
+	}
+	timer->running = enabled;
+}
+
+/*
+ * Raises a due update, as one interrupt when updates were missed.
+ */
+static void advance_timer(BasicTimer *timer){
+	if(!timer->running || sim_cycles < timer->next){
+		return;
+	}
+	*R(timer->base + TIM_SR) |= 1;
+	if(*R(timer->base + TIM_DIER) & 1){
+		sim_pend(timer->irq, timer->next);
+	}
+	timer->next += timer->period * ((sim_cycles - timer->next) / timer->period + 1);
+}
+
+/*
+ * Returns the ADC code of the scenario temperature, through the inverse of
+ * adc_to_milliF() with the sensor's 750mV at 25C and 10mV/C.
+ */
+static uint32_t adc_code(){
+	double fahrenheit = scenario_temperature(sim_cycles);
+	double milli_c = (fahrenheit - 32) * 5000 / 9;
+	double micro_volts = 750000 + (milli_c - 25000) * 10;
+	int32_t code = (int32_t)(micro_volts * 4095 / 3300000 + 0.5);
+	if(adc_noise > 0){
+		noise_state = noise_state * 1103515245 + 12345;
+		code += (int32_t)((noise_state >> 16) % (2*adc_noise + 1)) - adc_noise;
+	}
+	if(code < 0){
+		code = 0;
+	}else if(code > 4095){
+		code = 4095;
+	}
+	return code;
+}
+
+/*
+ * Returns port C input: the keypad matrix on PC0-7, pulled up, where a
+ * pressed key connects its row and column, and the LCD busy flag on PC11.
+ */
+static uint32_t gpioc_idr(){
+	uint32_t moder = *R(A_GPIOC + GPIO_MODER);
+	uint32_t odr = *R(A_GPIOC + GPIO_ODR);
+	uint32_t idr = 0;
+	for(int pin = 0; pin < 16; pin++){
+		if(((moder >> (2*pin)) & 3) == 1){
+			idr |= odr & (1u << pin);
+		}else if(pin < 8){
+			idr |= 1u << pin;
+		}
+	}
+
+	if(key_pressed >= 0){
+		int row = 4 + key_pressed / 4;
+		int col = key_pressed % 4;
+		int row_out = ((moder >> (2*row)) & 3) == 1;
+		int col_out = ((moder >> (2*col)) & 3) == 1;
+		if(row_out && !col_out && !(odr & (1u << row))){
+			idr &= ~(1u << col);
+		}else if(col_out && !row_out && !(odr & (1u << col))){
+			idr &= ~(1u << row);
+		}
+	}
+
+	uint32_t b_odr = *R(A_GPIOB + GPIO_ODR);
+	if(((moder >> 22) & 3) == 0 && (b_odr & 2) && (b_odr & 4)){
+		uint8_t busy = lcd_stuck || sim_cycles < lcd_busy_until;
+		if(busy){
+			idr |= 1u << 11;
+		}else if(lcd_in_transaction){
+			uint64_t cycles = sim_cycles - lcd_transaction_start;
+			lcd_in_transaction = 0;
+			lcd_stats.transactions++;
+			lcd_stats.transaction_total += cycles;
+			if(cycles > lcd_stats.transaction_max){
+				lcd_stats.transaction_max = cycles;
+			}
+		}
+	}
+	return idr;
+}
+
+/*
+ * Takes one nibble, high first. A busy read in between starts a new byte.
+ */
+static void lcd_latch(uint8_t rs, uint8_t nibble){
+	if(!lcd_in_transaction){
+		lcd_in_transaction = 1;
+		lcd_transaction_start = sim_cycles;
+	}
+	if(!lcd_have_nibble){
+		lcd_high_nibble = nibble;
+		lcd_have_nibble = 1;
+		return;
+	}
+	lcd_have_nibble = 0;
+	lcd_write(rs, (lcd_high_nibble << 4) | nibble);
+}
+
+/*
+ * Executes a command or stores a character, as an HD44780 with two 40
+ * character lines at DDRAM 0x00 and 0x40.
+ */
+static void lcd_write(uint8_t rs, uint8_t value){
+	if(lcd_stuck || sim_cycles < lcd_busy_until){
+		lcd_stats.busy_writes++;
+	}
+	uint32_t us = SIM_LCD_CMD_US;
+	if(rs){
+		lcd_stats.data++;
+		lcd_ram[lcd_address >> 6][lcd_address & 0x3F] = value;
+		lcd_address = (lcd_address & 0x40) | (((lcd_address & 0x3F) + 1) % 40);
+		lcd_dirty = 1;
+	}else{
+		lcd_stats.commands++;
+		if(value == 0x01){
+			memset(lcd_ram, ' ', sizeof(lcd_ram));
+			lcd_address = 0;
+			lcd_dirty = 1;
+			us = SIM_LCD_CLEAR_US;
+		}else if((value & 0xFE) == 0x02){
+			lcd_address = 0;
+			us = SIM_LCD_CLEAR_US;
+		}else if(value & 0x80){
+			lcd_address = value & 0x40 ? 0x40 | ((value & 0x3F) % 40) : (value & 0x3F) % 40;
+		}else if((value & 0xFC) == 0x14){
+			lcd_address = (lcd_address & 0x40) | (((lcd_address & 0x3F) + 1) % 40);
+		}
+	}
+	lcd_last_write = sim_cycles;
+	lcd_busy_until = sim_cycles + sim_ms_to_cycles(us / 1000.0);
+}
+
+/*
+ * Logs the 16 visible characters of both lines when they differ from what was
+ * last shown, so a redraw of the same text is quiet.
+ */
+static void lcd_show(){
+	char line[2][17];
+	for(int row = 0; row < 2; row++){
+		for(int col = 0; col < 16; col++){
+			char c = lcd_ram[row][col];
+			line[row][col] = (c >= ' ' && c < 0x7F) ? c : '?';
+		}
+		line[row][16] = '\0';
+	}
+	lcd_dirty = 0;
+	if(memcmp(line, lcd_shown, sizeof(line)) != 0){
+		memcpy(lcd_shown, line, sizeof(line));
+		sim_log("lcd |%s|%s|", line[0], line[1]);
+	}
+}
+
+/*
+ * Collects console output into lines. Binary telemetry frames, which end in a
+ * zero byte, are counted and not shown.
+ */
+static void uart_tx_byte(char c){
+	tx_bytes++;
+	if(c == '\0'){
+		tx_frames++;
+		tx_len = 0;
+		tx_binary = 0;
+	}else if(c == '\n'){
+		if(!tx_binary){
+			tx_line[tx_len] = '\0';
+			sim_log("uart| %s", tx_line);
+		}
+		tx_len = 0;
+		tx_binary = 0;
+	}else if(c == '\r'){
+		return;
+	}else if(c < ' ' || c >= 0x7F){
+		tx_binary = 1;
+	}else if(tx_len < (int)sizeof(tx_line) - 1){
+		tx_line[tx_len++] = c;
+	}
+}
+
+/*
+ * Logs a load gate turning on or off. A gate is on when its pin is in
+ * alternate function mode and its compare value is not zero.
+ */
+static void sync_gates(){
+	static const uint32_t ccr[NUM_GATES] = {A_TIM3 + TIM_CCR2, A_TIM1 + TIM_CCR1, A_TIM1 + TIM_CCR2};
+	static const uint32_t arr[NUM_GATES] = {A_TIM3 + TIM_ARR, A_TIM1 + TIM_ARR, A_TIM1 + TIM_ARR};
+	static const uint8_t pin[NUM_GATES] = {7, 8, 9};
+	uint32_t moder = *R(A_GPIOA + GPIO_MODER);
+	uint8_t now = 0;
+	for(int g = 0; g < NUM_GATES; g++){
+		if(((moder >> (2*pin[g])) & 3) == 2 && (*R(ccr[g]) & 0xFFFF) > 0){
+			now |= 1 << g;
+		}
+	}
+	if(now == gates){
+		return;
+	}
+	for(int g = 0; g < NUM_GATES; g++){
+		if(!((now ^ gates) & (1 << g))){
+			continue;
+		}
+		if(g == 1){
+			fan_on_since = sim_cycles;
+		}
+		if(now & (1 << g)){
+			uint32_t compare = *R(ccr[g]) & 0xFFFF;
+			uint32_t top = (*R(arr[g]) & 0xFFFF) + 1;
+			sim_log("gate %s on, duty %u%%", gate_names[g], compare >= top ? 100 : compare * 100 / top);
+		}else{
+			sim_log("gate %s off", gate_names[g]);
+		}
+	}
+	if(gate_changes < SIM_GATE_LOG){
+		gate_log[gate_changes].time = sim_cycles;
+		gate_log[gate_changes].gates = now;
+	}
+	gate_changes++;
+	gates = now;
+}
+
+/*
+ * Returns TIM2's count at a time, counting from zero when it was started.
+ */
+static uint32_t tim2_count(uint64_t when){
+	if(!tim2_running || tim2_tick_cycles == 0){
+		return 0;
+	}
+	return (uint32_t)((when - tim2_start) / tim2_tick_cycles);
+}
+
+/*
+ * Returns the fan speed. It follows the gate duty once the fan has been on for
+ * SIM_FAN_SPINUP_MS, and is 0 while seized or at too low a duty to turn.
+ */
+static uint32_t fan_rpm(){
+	if(!(gates & 2) || fan_stalled || sim_cycles < fan_on_since + sim_ms_to_cycles(SIM_FAN_SPINUP_MS)){
+		return 0;
+	}
+	uint32_t compare = *R(A_TIM1 + TIM_CCR1) & 0xFFFF;
+	uint32_t top = (*R(A_TIM1 + TIM_ARR) & 0xFFFF) + 1;
+	uint32_t percent = compare >= top ? 100 : compare * 100 / top;
+	return percent < SIM_FAN_MIN_DUTY ? 0 : SIM_FAN_RPM * percent / 100;
+}
+
+/*
+ * Captures a rising edge of the tach on TIM2 channel 1, when PA0 is routed to
+ * the timer. A capture not yet read is overwritten and flagged as overcaptured.
+ */
+static void tach_edge(uint64_t when){
+	if(!tim2_running || ((*R(A_GPIOA + GPIO_MODER) & 3) != 2) || !(*R(A_TIM2 + TIM_CCER) & 1)){
+		return;
+	}
+	if(tim2_sr & (1u<<1)){
+		tim2_sr |= 1u<<9;
+	}
+	tim2_sr |= 1u<<1;
+	*R(A_TIM2 + TIM_SR) = tim2_sr;
+	*R(A_TIM2 + TIM_CCR1) = tim2_count(when);
+	if(*R(A_TIM2 + TIM_DIER) & (1u<<1)){
+		sim_pend(28, when);
+	}
+}
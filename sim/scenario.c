@@ -0,0 +1,256 @@
+/*
+ * scenario.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * Scenario scripts for the host simulator. A script is a text file with one
+ * timed command per line, times in milliseconds from reset and in order:
+ *
+ * 		# comment
+ * 		0      temp 70			temperature point in F, linear between points
+ * 		0      noise 2			ADC noise, largest error in codes
+ * 		5000   key A 100		press a key, optionally held for a time in ms
+ * 		6000   uart stats		type a console line
+ * 		7000   lcd stuck		hang the LCD busy flag, "lcd ok" to recover
+ * 		8000   fan stall		seize the fan, "fan ok" to free it
+ * 		9000   tach float		edges each PWM cycle the fan gate is off, "tach ok" to stop
+ * 		60000  end				end the run
+ *
+ * Two temp points at the same time make a step. Before the first point the
+ * temperature is the first point's, after the last it stays at the last's.
+ * A script without an end stops one second after its last command.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+
+#define MAX_COMMANDS	1024
+#define MAX_POINTS		1024
+#define MAX_TEXT		80
+#define DEFAULT_TEMP_F	70.0
+#define DEFAULT_HOLD_MS	100
+#define IMPLICIT_END_MS	1000
+
+typedef enum {CMD_TEMP, CMD_NOISE, CMD_KEY, CMD_UART, CMD_LCD, CMD_FAN, CMD_TACH, CMD_END} Command;
+
+typedef struct {
+	double ms;
+	Command command;
+	double value;
+	char text[MAX_TEXT];
+} ScenarioLine;
+
+typedef struct {
+	double ms;
+	double fahrenheit;
+} TempPoint;
+
+static ScenarioLine lines[MAX_COMMANDS];
+static int num_lines;
+static int next_line;
+static TempPoint points[MAX_POINTS];
+static int num_points;
+static int point_cursor;
+static double release_ms = -1;
+
+static void run(const ScenarioLine *line);
+
+/*
+ * Reads a scenario script.
+ * Inputs:
+ * 		path - script file
+ * Outputs:
+ * 		0 on success, -1 with a message on a bad script
+ */
+int scenario_load(const char *path){
+	FILE *file = fopen(path, "r");
+	if(file == 0){
+		perror(path);
+		return -1;
+	}
+
+	char text[256];
+	int number = 0;
+	double last = 0;
+	int ended = 0;
+	while(fgets(text, sizeof(text), file) != 0){
+		number++;
+		text[strcspn(text, "#\r\n")] = '\0';
+
+		double ms;
+		char command[16];
+		int used;
+		if(sscanf(text, " %lf %15s %n", &ms, command, &used) < 2){
+			if(strspn(text, " \t") != strlen(text)){
+				fprintf(stderr, "%s:%d: expected <ms> <command>\n", path, number);
+				fclose(file);
+				return -1;
+			}
+			continue;
+		}
+		const char *args = text + used;
+
+		if(ms < last || num_lines == MAX_COMMANDS){
+			fprintf(stderr, "%s:%d: %s\n", path, number, ms < last ? "time goes backwards" : "too many commands");
+			fclose(file);
+			return -1;
+		}
+		last = ms;
+
+		ScenarioLine *line = &lines[num_lines];
+		memset(line, 0, sizeof(*line));
+		line->ms = ms;
+		int ok = 1;
+		if(strcmp(command, "temp") == 0){
+			line->command = CMD_TEMP;
+			ok = sscanf(args, "%lf", &line->value) == 1 && num_points < MAX_POINTS;
+			if(ok){
+				points[num_points].ms = ms;
+				points[num_points].fahrenheit = line->value;
+				num_points++;
+			}
+		}else if(strcmp(command, "noise") == 0){
+			line->command = CMD_NOISE;
+			ok = sscanf(args, "%lf", &line->value) == 1;
+		}else if(strcmp(command, "key") == 0){
+			line->command = CMD_KEY;
+			line->value = DEFAULT_HOLD_MS;
+			ok = sscanf(args, "%1s %lf", line->text, &line->value) >= 1;
+		}else if(strcmp(command, "uart") == 0){
+			line->command = CMD_UART;
+			strncpy(line->text, args, MAX_TEXT-1);
+		}else if(strcmp(command, "lcd") == 0){
+			line->command = CMD_LCD;
+			ok = sscanf(args, "%15s", line->text) == 1
+					&& (strcmp(line->text, "stuck") == 0 || strcmp(line->text, "ok") == 0);
+		}else if(strcmp(command, "fan") == 0){
+			line->command = CMD_FAN;
+			ok = sscanf(args, "%15s", line->text) == 1
+					&& (strcmp(line->text, "stall") == 0 || strcmp(line->text, "ok") == 0);
+		}else if(strcmp(command, "tach") == 0){
+			line->command = CMD_TACH;
+			ok = sscanf(args, "%15s", line->text) == 1
+					&& (strcmp(line->text, "float") == 0 || strcmp(line->text, "ok") == 0);
+		}else if(strcmp(command, "end") == 0){
+			line->command = CMD_END;
+			ended = 1;
+		}else{
+			ok = 0;
+		}
+		if(!ok){
+			fprintf(stderr, "%s:%d: bad command \"%s\"\n", path, number, command);
+			fclose(file);
+			return -1;
+		}
+		num_lines++;
+	}
+	fclose(file);
+
+	if(!ended && num_lines < MAX_COMMANDS){
+		memset(&lines[num_lines], 0, sizeof(lines[0]));
+		lines[num_lines].ms = last + IMPLICIT_END_MS;
+		lines[num_lines].command = CMD_END;
+		num_lines++;
+	}
+	return 0;
+}
+
+/*
+ * Runs the commands that are due.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void scenario_advance(){
+	double now = sim_cycles_to_ms(sim_cycles);
+	if(release_ms >= 0 && now >= release_ms){
+		release_ms = -1;
+		periph_set_key(0);
+	}
+	while(next_line < num_lines && now >= lines[next_line].ms){
+		run(&lines[next_line++]);
+	}
+}
+
+/*
+ * Returns the virtual time of the next command or key release.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		virtual time, SIM_FOREVER if the script is done
+ */
+uint64_t scenario_next_event(){
+	uint64_t next = SIM_FOREVER;
+	if(next_line < num_lines){
+		next = sim_ms_to_cycles(lines[next_line].ms);
+	}
+	if(release_ms >= 0 && sim_ms_to_cycles(release_ms) < next){
+		next = sim_ms_to_cycles(release_ms);
+	}
+	return next;
+}
+
+/*
+ * Returns the scripted temperature. Conversions come in time order, so the
+ * search continues from the previous one.
+ * Inputs:
+ * 		cycles - virtual time
+ * Outputs:
+ * 		temperature in F
+ */
+double scenario_temperature(uint64_t cycles){
+	if(num_points == 0){
+		return DEFAULT_TEMP_F;
+	}
+	double ms = sim_cycles_to_ms(cycles);
+	if(point_cursor > 0 && ms < points[point_cursor].ms){
+		point_cursor = 0;
+	}
+	while(point_cursor < num_points-1 && ms >= points[point_cursor+1].ms){
+		point_cursor++;
+	}
+	const TempPoint *from = &points[point_cursor];
+	if(point_cursor == num_points-1 || ms <= from->ms){
+		return from->fahrenheit;
+	}
+	const TempPoint *to = from + 1;
+	return from->fahrenheit + (to->fahrenheit - from->fahrenheit) * (ms - from->ms) / (to->ms - from->ms);
+}
+
+static void run(const ScenarioLine *line){
+	switch(line->command){
+		case CMD_TEMP:
+			break;
+		case CMD_NOISE:
+			periph_set_noise((int)line->value);
+			break;
+		case CMD_KEY:
+			sim_log("key %c", line->text[0]);
+			periph_set_key(line->text[0]);
+			release_ms = line->ms + line->value;
+			break;
+		case CMD_UART:
+			sim_log("uart> %s", line->text);
+			periph_uart_input(line->text);
+			break;
+		case CMD_LCD:
+			sim_log("lcd %s", line->text);
+			periph_lcd_stuck(strcmp(line->text, "stuck") == 0);
+			break;
+		case CMD_FAN:
+			sim_log("fan %s", line->text);
+			periph_fan_stalled(strcmp(line->text, "stall") == 0);
+			break;
+		case CMD_TACH:
+			sim_log("tach %s", line->text);
+			periph_tach_floating(strcmp(line->text, "float") == 0);
+			break;
+		case CMD_END:
+			sim_finish(0);
+			break;
+	}
+}
@@ -0,0 +1,431 @@
+/*
+ * sim.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * Core of the host simulator. The firmware is built with SIM_HOST, so every
+ * register access calls sim_reg(). Each call charges SIM_ACCESS_CYCLES of
+ * virtual time, lets the peripheral models see what was written since the last
+ * access, brings the models and the scenario up to the current time, and takes
+ * any pending interrupt the firmware has enabled and not masked, by calling its
+ * handler there and then. The access then completes against the register slot,
+ * so the firmware is preempted between accesses as it would be between
+ * instructions. WFI jumps virtual time to the next event.
+ *
+ * Everything is driven by virtual time and the scenario, so a run is
+ * deterministic and runs as fast as the host allows.
+ */
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#include "sim.h"
+#include "system_clock.h"
+#include "nvic.h"
+
+#define DEFAULT_RUN_MS	10000
+
+extern int firmware_main();
+extern void TIM2_IRQHandler();
+extern void TIM6_DAC_IRQHandler();
+extern void TIM7_IRQHandler();
+extern void USART2_IRQHandler();
+extern void DMA1_Stream6_IRQHandler();
+
+typedef struct {
+	int irq;
+	const char *name;
+	void (*handler)();
+} IrqVector;
+
+//the vectors the firmware uses
+static const IrqVector vectors[] = {
+	{DMA1_Stream6_IRQn,	"dma1 stream6",	DMA1_Stream6_IRQHandler},
+	{TIM2_IRQn,			"tim2 tach",	TIM2_IRQHandler},
+	{USART2_IRQn,		"usart2",		USART2_IRQHandler},
+	{TIM6_DAC_IRQn,		"tim6 control",	TIM6_DAC_IRQHandler},
+	{TIM7_IRQn,			"tim7 tick",	TIM7_IRQHandler},
+};
+#define NUM_VECTORS (sizeof(vectors) / sizeof(vectors[0]))
+
+typedef struct {
+	uint64_t count;
+	uint64_t latency_total;
+	uint64_t latency_max;
+	uint64_t duration_total;
+	uint64_t duration_max;
+} IrqStats;
+
+uint64_t sim_cycles;
+uint64_t sim_end = SIM_FOREVER;
+int sim_quiet;
+uint32_t sim_primask;
+
+volatile uint32_t sim_periph_regs[SIM_PERIPH_SIZE / 4];
+volatile uint32_t sim_ppb_regs[SIM_PPB_SIZE / 4];
+static uint8_t pending[SIM_IRQS];
+static uint64_t raised_at[SIM_IRQS];
+static IrqStats irq_stats[NUM_VECTORS];
+static int active_priority = 256;		//thread mode
+static uint64_t accesses;
+static const char *flash_image;
+static struct timespec host_start;
+
+static void dispatch();
+static int highest_pending();
+static int dispatchable();
+static void load_flash(const char *path);
+static void save_flash(const char *path);
+static void usage();
+
+/*
+ * Returns the simulated slot of a register without any side effects.
+ * Inputs:
+ * 		addr - register address
+ * Outputs:
+ * 		pointer to the slot, the run ends on an unmapped address
+ */
+volatile uint32_t *sim_mem(uint32_t addr){
+	if(addr - SIM_PERIPH_BASE < SIM_PERIPH_SIZE){
+		return &sim_periph_regs[(addr - SIM_PERIPH_BASE) / 4];
+	}
+	if(addr - SIM_PPB_BASE < SIM_PPB_SIZE){
+		return &sim_ppb_regs[(addr - SIM_PPB_BASE) / 4];
+	}
+	fprintf(stderr, "sim: access to unmapped register 0x%08X\n", addr);
+	sim_finish(2);
+	return 0;
+}
+
+/*
+ * Register access from the firmware, see the file description.
+ * Inputs:
+ * 		addr - register address
+ * Outputs:
+ * 		pointer to the register slot
+ */
+volatile uint32_t *sim_reg(uint32_t addr){
+	volatile uint32_t *slot = sim_mem(addr);
+	accesses++;
+	sim_cycles += SIM_ACCESS_CYCLES;
+	periph_sync();
+	sim_service();
+	periph_access(addr, slot);
+	return slot;
+}
+
+/*
+ * Byte register access, used for the NVIC priority registers.
+ * Inputs:
+ * 		addr - register address
+ * Outputs:
+ * 		pointer to the register byte
+ */
+volatile uint8_t *sim_reg8(uint32_t addr){
+	volatile uint8_t *word = (volatile uint8_t*)sim_reg(addr & ~3u);
+	return word + (addr & 3);
+}
+
+/*
+ * Brings the models and the scenario up to the current time, takes pending
+ * interrupts and ends the run once its time is up.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void sim_service(){
+	periph_advance();
+	scenario_advance();
+	if(sim_cycles >= sim_end){
+		sim_finish(0);
+	}
+	dispatch();
+}
+
+/*
+ * WFI. Returns once an interrupt is pending, moving virtual time to each next
+ * event until one is, and takes it unless interrupts are masked.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void sim_wfi(){
+	sim_cycles += SIM_ACCESS_CYCLES;
+	periph_sync();
+	while(highest_pending() < 0){
+		uint64_t next = periph_next_event();
+		uint64_t scenario = scenario_next_event();
+		if(scenario < next){
+			next = scenario;
+		}
+		if(sim_end < next){
+			next = sim_end;
+		}
+		if(next > sim_cycles){
+			sim_cycles = next;
+		}
+		periph_advance();
+		scenario_advance();
+		if(sim_cycles >= sim_end){
+			sim_finish(0);
+		}
+	}
+	dispatch();
+}
+
+/*
+ * Moves virtual time forward to when, as firmware busy waiting on a flag that
+ * is known to change then would, stopping early for any other event so
+ * interrupts are still taken on time.
+ * Inputs:
+ * 		when - virtual time the awaited flag changes
+ * Outputs:
+ * 		none
+ */
+void sim_skip_to(uint64_t when){
+	uint64_t next = periph_next_event();
+	uint64_t scenario = scenario_next_event();
+	if(scenario < next){
+		next = scenario;
+	}
+	if(sim_end < next){
+		next = sim_end;
+	}
+	if(when < next){
+		next = when;
+	}
+	if(next > sim_cycles){
+		sim_cycles = next;
+		sim_service();
+	}
+}
+
+/*
+ * Marks an interrupt pending, as a peripheral would.
+ * Inputs:
+ * 		irq - interrupt number
+ * 		raised - virtual time of the event that raised it, for the latency
+ * Outputs:
+ * 		none
+ */
+void sim_pend(int irq, uint64_t raised){
+	if(!pending[irq]){
+		pending[irq] = 1;
+		raised_at[irq] = raised;
+	}
+}
+
+uint64_t sim_ms_to_cycles(double ms){
+	return (uint64_t)(ms * (SystemCoreClock / 1000.0) + 0.5);
+}
+
+double sim_cycles_to_ms(uint64_t cycles){
+	return cycles / (SystemCoreClock / 1000.0);
+}
+
+/*
+ * Writes one simulator message, stamped with the virtual time in
+ * milliseconds.
+ */
+void sim_log(const char *format, ...){
+	if(sim_quiet){
+		return;
+	}
+	va_list args;
+	va_start(args, format);
+	printf("@%10.3f ", sim_cycles_to_ms(sim_cycles));
+	vprintf(format, args);
+	printf("\n");
+	va_end(args);
+}
+
+/*
+ * Ends the run: flushes the models, writes the report and the flash image,
+ * and exits.
+ * Inputs:
+ * 		status - exit status
+ * Outputs:
+ * 		none, does not return
+ */
+void sim_finish(int status){
+	struct timespec host_end;
+	clock_gettime(CLOCK_MONOTONIC, &host_end);
+	double host_s = (host_end.tv_sec - host_start.tv_sec) + (host_end.tv_nsec - host_start.tv_nsec) / 1e9;
+	double virtual_s = sim_cycles_to_ms(sim_cycles) / 1000.0;
+
+	periph_finish();
+	printf("# virtual %.3f s, %llu cycles, %llu register accesses\n", virtual_s,
+			(unsigned long long)sim_cycles, (unsigned long long)accesses);
+	printf("# host %.3f s, %.1fx real time\n", host_s, host_s > 0 ? virtual_s / host_s : 0);
+	sim_report_irqs(stdout);
+	periph_report(stdout);
+	if(flash_image){
+		save_flash(flash_image);
+	}
+	fflush(stdout);
+	exit(status);
+}
+
+/*
+ * Writes the count, entry latency and handler time of every interrupt taken,
+ * in cycles. Latency runs from the event that raised the interrupt to handler
+ * entry, so it includes time spent masked or behind a higher priority handler.
+ */
+void sim_report_irqs(FILE *out){
+	for(unsigned int i = 0; i < NUM_VECTORS; i++){
+		const IrqStats *stats = &irq_stats[i];
+		if(stats->count == 0){
+			continue;
+		}
+		fprintf(out, "# irq %-13s %8llu runs, latency avg %5llu max %6llu, time avg %5llu max %6llu cycles\n",
+				vectors[i].name, (unsigned long long)stats->count,
+				(unsigned long long)(stats->latency_total / stats->count), (unsigned long long)stats->latency_max,
+				(unsigned long long)(stats->duration_total / stats->count), (unsigned long long)stats->duration_max);
+	}
+}
+
+/*
+ * Returns the vector index of the pending interrupt that could preempt what is
+ * running, masked or not, or -1. Lower priority values win, then lower
+ * interrupt numbers, as in the NVIC.
+ */
+static int highest_pending(){
+	int best = -1;
+	int best_priority = active_priority;
+	for(unsigned int i = 0; i < NUM_VECTORS; i++){
+		int irq = vectors[i].irq;
+		uint32_t enabled = sim_ppb_regs[(0xE100 + 4*(irq >> 5)) / 4] & (1u << (irq & 0x1F));
+		int priority = ((volatile uint8_t*)sim_ppb_regs)[0xE400 + irq] >> 4;
+		if(pending[irq] && enabled && priority < best_priority){
+			best = i;
+			best_priority = priority;
+		}
+	}
+	return best;
+}
+
+/*
+ * Returns the vector index of the interrupt that would be taken now, or -1.
+ */
+static int dispatchable(){
+	return sim_primask ? -1 : highest_pending();
+}
+
+/*
+ * Takes pending interrupts until none can preempt what is running.
+ */
+static void dispatch(){
+	int i;
+	while((i = dispatchable()) >= 0){
+		int irq = vectors[i].irq;
+		IrqStats *stats = &irq_stats[i];
+		pending[irq] = 0;
+
+		uint64_t latency = sim_cycles - raised_at[irq];
+		stats->count++;
+		stats->latency_total += latency;
+		if(latency > stats->latency_max){
+			stats->latency_max = latency;
+		}
+
+		int saved = active_priority;
+		active_priority = ((volatile uint8_t*)sim_ppb_regs)[0xE400 + irq] >> 4;
+		uint64_t start = sim_cycles;
+		sim_cycles += SIM_IRQ_ENTRY_CYCLES;
+		vectors[i].handler();
+		sim_cycles += SIM_IRQ_EXIT_CYCLES;
+		active_priority = saved;
+
+		uint64_t duration = sim_cycles - start;
+		stats->duration_total += duration;
+		if(duration > stats->duration_max){
+			stats->duration_max = duration;
+		}
+	}
+}
+
+static void load_flash(const char *path){
+	FILE *file = fopen(path, "rb");
+	if(file == 0){
+		return;
+	}
+	size_t read = fread((void*)(uintptr_t)SIM_FLASH_BASE, 1, SIM_FLASH_SIZE, file);
+	fclose(file);
+	if(read != SIM_FLASH_SIZE){
+		fprintf(stderr, "sim: %s is not a %u byte flash image, ignored\n", path, SIM_FLASH_SIZE);
+		memset((void*)(uintptr_t)SIM_FLASH_BASE, 0xFF, SIM_FLASH_SIZE);
+	}
+}
+
+static void save_flash(const char *path){
+	FILE *file = fopen(path, "wb");
+	if(file == 0 || fwrite((void*)(uintptr_t)SIM_FLASH_BASE, 1, SIM_FLASH_SIZE, file) != SIM_FLASH_SIZE){
+		fprintf(stderr, "sim: could not write %s\n", path);
+	}
+	if(file){
+		fclose(file);
+	}
+}
+
+static void usage(){
+	fprintf(stderr,
+			"usage: sim [-t ms] [-f flash.bin] [-q] [scenario]\n"
+			"  -t ms        virtual time to run, default %d or until the scenario ends\n"
+			"  -f file      flash image, loaded if present and saved at the end\n"
+			"  -q           report only, no event messages\n", DEFAULT_RUN_MS);
+	exit(2);
+}
+
+int main(int argc, char **argv){
+	double run_ms = -1;
+	const char *scenario = 0;
+	for(int i = 1; i < argc; i++){
+		if(strcmp(argv[i], "-t") == 0 && i+1 < argc){
+			run_ms = atof(argv[++i]);
+		}else if(strcmp(argv[i], "-f") == 0 && i+1 < argc){
+			flash_image = argv[++i];
+		}else if(strcmp(argv[i], "-q") == 0){
+			sim_quiet = 1;
+		}else if(argv[i][0] == '-' || scenario != 0){
+			usage();
+		}else{
+			scenario = argv[i];
+		}
+	}
+
+	//flash is mapped at its real address, erased unless an image is loaded
+	void *flash = mmap((void*)(uintptr_t)SIM_FLASH_BASE, SIM_FLASH_SIZE, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+	if(flash != (void*)(uintptr_t)SIM_FLASH_BASE){
+		fprintf(stderr, "sim: cannot map flash at 0x%08X\n", SIM_FLASH_BASE);
+		return 2;
+	}
+	memset(flash, 0xFF, SIM_FLASH_SIZE);
+	if(flash_image){
+		load_flash(flash_image);
+	}
+
+	if(scenario != 0 && scenario_load(scenario) < 0){
+		return 2;
+	}
+	periph_init();
+	clock_gettime(CLOCK_MONOTONIC, &host_start);
+
+	//what the reset handler does before main
+	SystemInit();
+	if(run_ms < 0 && scenario_next_event() == SIM_FOREVER){
+		run_ms = DEFAULT_RUN_MS;
+	}
+	if(run_ms >= 0){
+		sim_end = sim_cycles + sim_ms_to_cycles(run_ms);
+	}
+	firmware_main();
+	sim_finish(0);
+	return 0;
+}
@@ -0,0 +1,78 @@
+/*
+ * sim.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <inttypes.h>
+#include <stdio.h>
+
+/*
+ * Simulated memory map. Peripheral and private peripheral bus registers live in
+ * two arrays reached through sim_reg(). Flash is mapped at its real address so
+ * the settings store and event log can use plain pointers.
+ */
+#define SIM_PERIPH_BASE		0x40000000
+#define SIM_PERIPH_SIZE		0x00030000
+#define SIM_PPB_BASE		0xE0000000
+#define SIM_PPB_SIZE		0x00043000
+#define SIM_FLASH_BASE		0x08000000
+#define SIM_FLASH_SIZE		0x00080000
+
+/*
+ * Virtual time is counted in core cycles. Code between register accesses is
+ * free, every access costs SIM_ACCESS_CYCLES, and exception entry and exit cost
+ * what the Cortex-M4 takes with no wait states.
+ */
+#define SIM_ACCESS_CYCLES	4
+#define SIM_IRQ_ENTRY_CYCLES	12
+#define SIM_IRQ_EXIT_CYCLES	12
+#define SIM_FOREVER			UINT64_MAX
+
+//interrupts the models raise, NVIC numbering
+#define SIM_IRQS			96
+
+//run state shared by the simulator modules
+extern uint64_t sim_cycles;
+extern uint64_t sim_end;
+extern int sim_quiet;
+extern volatile uint32_t sim_periph_regs[SIM_PERIPH_SIZE / 4];
+extern volatile uint32_t sim_ppb_regs[SIM_PPB_SIZE / 4];
+
+//core
+extern volatile uint32_t *sim_mem(uint32_t addr);
+extern void sim_pend(int irq, uint64_t raised);
+extern void sim_skip_to(uint64_t when);
+extern void sim_service();
+extern void sim_finish(int status);
+extern uint64_t sim_ms_to_cycles(double ms);
+extern double sim_cycles_to_ms(uint64_t cycles);
+extern void sim_log(const char *format, ...) __attribute__((format(printf, 1, 2)));
+extern void sim_report_irqs(FILE *out);
+
+//peripheral models
+extern void periph_init();
+extern void periph_sync();
+extern void periph_access(uint32_t addr, volatile uint32_t *slot);
+extern void periph_advance();
+extern uint64_t periph_next_event();
+extern void periph_set_key(char key);
+extern void periph_set_noise(int lsb);
+extern void periph_uart_input(const char *text);
+extern void periph_lcd_stuck(int stuck);
+extern void periph_fan_stalled(int stalled);
+extern void periph_tach_floating(int floating);
+extern void periph_finish();
+extern void periph_report(FILE *out);
+
+//scenario script
+extern int scenario_load(const char *path);
+extern void scenario_advance();
+extern uint64_t scenario_next_event();
+extern double scenario_temperature(uint64_t cycles);
+
+#endif /* SIM_H */
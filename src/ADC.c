@@ -20,6 +20,13 @@
 void ADC_init(){
 	//enable clock for ADC1
 	*(APB2ENR) |= 1<<8;
+
+	//divide APB2 by the smallest of 2, 4, 6 or 8 that keeps the ADC within its limit
+	uint32_t pre = 0;
+	while(pre < 3 && clock_get_pclk2() / (2*(pre+1)) > ADC_MAX_CLK){
+		pre++;
+	}
+	*(ADC_CCR) = (*(ADC_CCR) & ~(3<<ADC_CCR_ADCPRE_F)) | (pre<<ADC_CCR_ADCPRE_F);
 	
 	//enable clock for GPIOA
 	enable_clock('A');
@@ -44,16 +51,66 @@ void ADC_init(){
  * 		data in the DR register
  */
 uint32_t take_sample(){
-	//start conversion by setting SWSTART bit in ADC_CR2
-	*(ADC_CR2) |= (1<<30);
+	adc_start_conversion();
 	
 	//wait for EOC bit to be set
-	while((*(ADC_SR) & (1<<1))==0){}
+	while(!adc_conversion_done()){}
 	
-	//return data in ADC_DR
+	return adc_read();
+}
+
+/**
+ * This function starts a conversion on the ADC without waiting for it to
+ * finish.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void adc_start_conversion(){
+	//start conversion by setting SWSTART bit in ADC_CR2
+	*(ADC_CR2) |= (1<<ADC_CR2_SWSTART_F);
+}
+
+/**
+ * This function reports whether the last conversion started has finished.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		1 if a result is waiting in the data register, 0 otherwise
+ */
+uint8_t adc_conversion_done(){
+	return (*(ADC_SR) >> ADC_SR_EOC_F) & 1;
+}
+
+/**
+ * This function returns the result of the last conversion. Reading the data
+ * register clears the EOC flag. The upper half word is cleared in the DR to
+ * ensure no garbage data is returned.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		data in the DR register
+ */
+uint32_t adc_read(){
 	return (*(ADC_DR) & 0xFFFF);
 }
 
+/**
+ * This function converts a raw ADC code from the temperature sensor to
+ * thousandths of a degree Ferenheit using integer math only. It matches
+ * get_tempF() and is cheap enough to call from an interrupt.
+ * Inputs:
+ * 		code - 12 bit conversion result
+ * Outputs:
+ * 		temperature in thousandths of a degree Ferenheit
+ */
+int32_t adc_to_milliF(uint32_t code){
+	int32_t micro_volts = (int32_t)(((uint64_t)code * 3300000) / 4095);
+	int32_t milliC = 25000 + (micro_volts - 750000) / 10;
+	return (milliC * 9) / 5 + 32000;
+}
+
 /**
  * This function will return a temperature representation of the data in
  * the data register in celcius using previously defined functions
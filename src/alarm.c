@@ -0,0 +1,130 @@
+/*
+ * alarm.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements the alarm decision logic: the user offset, the power-on
+ * reference, the rule table with its hysteresis and hold times, the rate of
+ * rise trip and the gate levels that follow from them. It takes samples and
+ * times and returns gate commands, and touches no hardware, so the same code
+ * runs on the board and in the host replay tool.
+ */
+
+#include "alarm.h"
+
+static uint16_t led_duty(const Rule *led, int32_t rise_milliF);
+
+/*
+ * This function resets the alarm state. Every load starts off with its off hold
+ * time already served.
+ * Inputs:
+ * 		*core - alarm state
+ * 		*rules - rule table, NUM_LOADS rows
+ * 		*trip - rate of rise trip
+ * 		power_on_milliF - reference temperature in thousandths of a degree
+ * 		now_ms - current time
+ * Outputs:
+ * 		none
+ */
+void alarm_init(AlarmCore *core, Rule *rules, RateTrip *trip, int32_t power_on_milliF, uint32_t now_ms){
+	core->rules = rules;
+	core->trip = trip;
+	core->power_on_milliF = power_on_milliF;
+	core->offset_milliF = 0;
+	core->rate_milliF = 0;
+	core->next_rate_ms = now_ms + RATE_PERIOD;
+	core->loads = 0;
+	trip->active = 0;
+	rules_init(rules, core->states, NUM_LOADS, now_ms);
+	rate_init(&core->rate);
+}
+
+/*
+ * This function sets the user offset added to every sample.
+ * Inputs:
+ * 		*core - alarm state
+ * 		offset_milliF - offset in thousandths of a degree
+ * Outputs:
+ * 		none
+ */
+void alarm_set_offset(AlarmCore *core, int32_t offset_milliF){
+	core->offset_milliF = offset_milliF;
+}
+
+/*
+ * This function moves the reference the thresholds are measured from.
+ * Inputs:
+ * 		*core - alarm state
+ * 		power_on_milliF - reference temperature in thousandths of a degree
+ * Outputs:
+ * 		none
+ */
+void alarm_set_power_on(AlarmCore *core, int32_t power_on_milliF){
+	core->power_on_milliF = power_on_milliF;
+}
+
+/*
+ * This function runs one alarm evaluation. Once every RATE_PERIOD the sample
+ * without the offset is added to the rate window, so offset changes are not
+ * seen as a ramp. The rule table then runs on the rise of the offset sample
+ * above the power-on temperature, and the rate trip adds its loads. The LED
+ * dims between its off and on thresholds, the siren is fully on and the fan is
+ * handed to the PID loop.
+ * Inputs:
+ * 		*core - alarm state
+ * 		sensor_milliF - measured temperature in thousandths of a degree
+ * 		now_ms - time of the sample, milliseconds on a wrapping clock
+ * 		*out - gate commands
+ * Outputs:
+ * 		none
+ */
+void alarm_step(AlarmCore *core, int32_t sensor_milliF, uint32_t now_ms, AlarmOutput *out){
+	out->rate_updated = 0;
+	if((int32_t)(now_ms - core->next_rate_ms) >= 0){
+		rate_update(&core->rate, sensor_milliF);
+		core->rate_milliF = rate_per_minute(&core->rate, RATE_PERIOD);
+		//stay on the RATE_PERIOD grid unless samples stopped for a whole period
+		core->next_rate_ms += RATE_PERIOD;
+		if((int32_t)(now_ms - core->next_rate_ms) >= 0){
+			core->next_rate_ms = now_ms + RATE_PERIOD;
+		}
+		out->rate_updated = 1;
+	}
+
+	out->milliF = sensor_milliF + core->offset_milliF;
+	out->rise_milliF = out->milliF - core->power_on_milliF;
+
+	uint8_t was_tripped = core->trip->active;
+	uint32_t loads = rules_evaluate(core->rules, core->states, NUM_LOADS, out->rise_milliF, now_ms);
+	loads |= rate_trip_evaluate(core->trip, &core->rate, core->rate_milliF);
+	out->rate_changed = core->trip->active != was_tripped;
+
+	out->loads = loads;
+	out->changed = loads ^ core->loads;
+	core->loads = loads;
+
+	out->led_duty = (loads & (1<<LOAD_LED)) ? led_duty(&core->rules[LOAD_LED], out->rise_milliF) : 0;
+	out->siren_duty = (loads & (1<<LOAD_SIREN)) ? PWM_DUTY_MAX : 0;
+	out->fan_enable = (loads >> LOAD_FAN) & 1;
+}
+
+/*
+ * This helper function scales the LED brightness with the rise, from dim at
+ * the LED's off threshold to full at its on threshold.
+ * Inputs:
+ * 		*led - LED rule
+ * 		rise_milliF - rise above the power-on temperature
+ * Outputs:
+ * 		LED duty
+ */
+static uint16_t led_duty(const Rule *led, int32_t rise_milliF){
+	int32_t span = led->on_milliF - led->off_milliF;
+	int32_t above = rise_milliF - led->off_milliF;
+	if(above <= 0 || span <= 0){
+		return ALARM_MIN_LED_DUTY;
+	}else if(above >= span){
+		return PWM_DUTY_MAX;
+	}
+	return ALARM_MIN_LED_DUTY + (above * (PWM_DUTY_MAX - ALARM_MIN_LED_DUTY)) / span;
+}
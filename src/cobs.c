@@ -0,0 +1,100 @@
+/*
+ * cobs.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements Consistent Overhead Byte Stuffing and the CRC used to
+ * frame binary data on the console. COBS removes every zero byte from a frame,
+ * so a single zero can mark the end of a frame and a receiver can always find
+ * the next frame boundary after an error. The code has no hardware dependencies
+ * and is shared with the host side tools.
+ */
+
+#include "cobs.h"
+
+/*
+ * This function COBS encodes a block of bytes. The output contains no zero
+ * bytes and does not include the frame delimiter.
+ * Inputs:
+ * 		*in - bytes to encode
+ * 		len - number of bytes
+ * 		*out - output buffer, at least COBS_MAX_ENCODED(len) bytes
+ * Outputs:
+ * 		number of bytes written to out
+ */
+uint32_t cobs_encode(const uint8_t *in, uint32_t len, uint8_t *out){
+	uint32_t code_pos = 0;		//where the current run length goes
+	uint32_t out_pos = 1;
+	uint8_t code = 1;
+
+	for(uint32_t i = 0; i < len; i++){
+		if(in[i] == 0){
+			out[code_pos] = code;
+			code_pos = out_pos++;
+			code = 1;
+		}else{
+			out[out_pos++] = in[i];
+			code++;
+			if(code == 0xFF){
+				out[code_pos] = code;
+				code_pos = out_pos++;
+				code = 1;
+			}
+		}
+	}
+	out[code_pos] = code;
+	return out_pos;
+}
+
+/*
+ * This function decodes a COBS encoded block, without its frame delimiter.
+ * Inputs:
+ * 		*in - encoded bytes
+ * 		len - number of encoded bytes
+ * 		*out - output buffer, at least len bytes
+ * Outputs:
+ * 		number of bytes decoded, or -1 if the block is not valid COBS
+ */
+int32_t cobs_decode(const uint8_t *in, uint32_t len, uint8_t *out){
+	uint32_t in_pos = 0;
+	uint32_t out_pos = 0;
+
+	while(in_pos < len){
+		uint8_t code = in[in_pos++];
+		if(code == 0 || in_pos + code - 1 > len){
+			return -1;
+		}
+		for(uint8_t i = 1; i < code; i++){
+			if(in[in_pos] == 0){
+				return -1;
+			}
+			out[out_pos++] = in[in_pos++];
+		}
+		//a short run stands for a zero, except at the end of the block
+		if(code != 0xFF && in_pos < len){
+			out[out_pos++] = 0;
+		}
+	}
+	return out_pos;
+}
+
+/*
+ * This function computes a CRC-16/CCITT(polynomial 0x1021) over a block of
+ * bytes, bit by bit so no table is needed in flash. Start with crc 0xFFFF.
+ * Inputs:
+ * 		*data - bytes to check
+ * 		len - number of bytes
+ * 		crc - CRC of the preceding bytes, or the initial value
+ * Outputs:
+ * 		updated CRC
+ */
+uint16_t crc16_ccitt(const uint8_t *data, uint32_t len, uint16_t crc){
+	for(uint32_t i = 0; i < len; i++){
+		crc ^= (uint16_t)data[i] << 8;
+		for(int bit = 0; bit < 8; bit++){
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+		}
+	}
+	return crc;
+}
@@ -0,0 +1,173 @@
+/*
+ * control.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements the fan control loop. TIM6 interrupts at CONTROL_RATE_HZ,
+ * and each interrupt collects the ADC conversion started by the previous one,
+ * starts the next, low pass filters the temperature and updates the fan PID.
+ * Once every HISTORY_PERIOD the filtered temperature is appended to the history.
+ * The loop checks in with the watchdog only when a conversion has completed.
+ * Nothing in the interrupt waits on hardware, so the loop costs a few hundred
+ * cycles per update.
+ */
+
+#include "control.h"
+
+static PID fan_pid;
+static volatile int32_t setpoint;
+static volatile int32_t offset;
+static volatile int32_t filtered;		//filtered temperature, Q(CONTROL_FILTER_SHIFT) thousandths of a degree
+static volatile uint32_t raw;
+static volatile uint8_t fan_enabled;
+static uint16_t history_count;
+
+/*
+ * This function initializes the control loop. The ADC must already be initialized.
+ * The temperature filter is seeded from a blocking sample so the loop starts from
+ * the current temperature, then TIM6 is started at CONTROL_RATE_HZ. The fan is
+ * held off until control_enable_fan() is called.
+ * Inputs:
+ * 		setpoint_milliF - fan setpoint in thousandths of a degree Ferenheit
+ * Outputs:
+ * 		none
+ */
+void control_init(int32_t setpoint_milliF){
+	pid_init(&fan_pid, FAN_KP, FAN_KI, FAN_KD, 0, PWM_DUTY_MAX, FAN_D_SHIFT);
+	setpoint = setpoint_milliF;
+	offset = 0;
+	fan_enabled = 0;
+
+	raw = take_sample();
+	filtered = adc_to_milliF(raw) << CONTROL_FILTER_SHIFT;
+	adc_start_conversion();
+
+	//TIM6 counts at 1MHz and overflows at the control rate
+	*(RCC_APB1ENR) |= (1<<TIM6_RCCEN_F);
+	*(TIM6_PSC) = (clock_get_apb1_timer_clk() / 1000000) - 1;
+	*(TIM6_ARR) = (1000000 / CONTROL_RATE_HZ) - 1;
+	*(TIM6_DIER) |= (1<<TIM_DIER_UIE_F);
+	NVIC_PRIORITY(TIM6_DAC_IRQn, CONTROL_IRQ_PRIORITY);
+	NVIC_ENABLE(TIM6_DAC_IRQn);
+	*(TIM6_CR1) |= (1<<TIM_CR1_CEN_F);
+}
+
+/*
+ * This function changes the temperature the fan regulates to.
+ * Inputs:
+ * 		setpoint_milliF - fan setpoint in thousandths of a degree Ferenheit
+ * Outputs:
+ * 		none
+ */
+void control_set_setpoint(int32_t setpoint_milliF){
+	setpoint = setpoint_milliF;
+}
+
+/*
+ * This function sets the user offset added to every measured temperature.
+ * Inputs:
+ * 		offset_milliF - offset in thousandths of a degree Ferenheit
+ * Outputs:
+ * 		none
+ */
+void control_set_offset(int32_t offset_milliF){
+	offset = offset_milliF;
+}
+
+/*
+ * This function returns the user offset added to every measured temperature.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		offset in thousandths of a degree Ferenheit
+ */
+int32_t control_get_offset(){
+	return offset;
+}
+
+/*
+ * This function enables or disables PID control of the fan. While disabled
+ * the fan is held off and the controller state is cleared.
+ * Inputs:
+ * 		enable - 1 to regulate the fan, 0 to hold it off
+ * Outputs:
+ * 		none
+ */
+void control_enable_fan(uint8_t enable){
+	if(enable != fan_enabled){
+		trace(TRACE_FAN, enable);
+	}
+	fan_enabled = enable;
+}
+
+/*
+ * This function returns the filtered temperature with the offset applied.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		temperature in thousandths of a degree Ferenheit
+ */
+int32_t control_get_milliF(){
+	return (filtered >> CONTROL_FILTER_SHIFT) + offset;
+}
+
+/*
+ * This function returns the filtered temperature with the offset applied.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		temperature in degrees Ferenheit
+ */
+float control_get_tempF(){
+	return control_get_milliF() / 1000.0f;
+}
+
+/*
+ * This function returns the most recent raw ADC code.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		12 bit conversion result
+ */
+uint32_t control_get_raw(){
+	return raw;
+}
+
+/*
+ * TIM6 update interrupt, runs one step of the control loop.
+ */
+void TIM6_DAC_IRQHandler(){
+	PROF_BEGIN(PROF_CONTROL);
+	*(TIM6_SR) &= ~(1<<TIM_SR_UIF_F);
+
+	//collect the conversion started last update and start the next one
+	if(adc_conversion_done()){
+		raw = adc_read();
+		int32_t sample = adc_to_milliF(raw) << CONTROL_FILTER_SHIFT;
+		filtered += (sample - filtered) >> CONTROL_FILTER_SHIFT;
+		WATCHDOG_CHECKIN(WATCHDOG_CONTROL);
+	}
+	adc_start_conversion();
+
+	uint8_t hold = tach_window();
+	if(fan_enabled){
+		PROF_BEGIN(PROF_PID);
+		int32_t duty = pid_update(&fan_pid, setpoint, control_get_milliF());
+		PROF_END(PROF_PID);
+		//a running fan is held fully on while the tach measures it
+		if(duty > 0 && hold){
+			duty = PWM_DUTY_MAX;
+		}
+		pwm_set_duty(LOAD_FAN, duty);
+	}else{
+		pid_reset(&fan_pid);
+		pwm_set_duty(LOAD_FAN, 0);
+	}
+
+	if(++history_count >= CONTROL_RATE_HZ * HISTORY_PERIOD / 1000){
+		history_count = 0;
+		history_append(get_time_ms() / 1000, control_get_milliF() / 100);
+	}
+	PROF_END(PROF_CONTROL);
+}
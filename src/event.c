@@ -0,0 +1,201 @@
+/*
+ * event.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements a run-to-completion event dispatcher. Events are posted
+ * from interrupts or from periodic timers and kept in a pending bit mask. The
+ * dispatcher always runs the highest priority pending handler next, so a control
+ * event posted while the display is refreshing waits for at most one handler.
+ * When nothing is pending the core sleeps until the next interrupt.
+ */
+
+#include "event.h"
+
+static EventHandler handlers[NUM_EVENTS];
+static uint32_t periods[NUM_EVENTS];
+static uint32_t next_due[NUM_EVENTS];
+static volatile uint32_t pending;
+
+static EventStats event_stats[NUM_EVENTS];
+static LoopStats loop_stats;
+
+static void post_due_timers(uint32_t now);
+static void dispatch(Event event);
+
+/*
+ * This function clears all handlers, timers and pending events, and starts the
+ * cycle counter used for the dispatch statistics.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void event_init(){
+	for(int i = 0; i < NUM_EVENTS; i++){
+		handlers[i] = 0;
+		periods[i] = 0;
+	}
+	pending = 0;
+	event_clear_stats();
+	DWT_INIT();
+}
+
+/*
+ * This function sets the handler run when an event is dispatched.
+ * Inputs:
+ * 		event - event to handle
+ * 		handler - function to run, 0 to ignore the event
+ * Outputs:
+ * 		none
+ */
+void event_register(Event event, EventHandler handler){
+	if(event < NUM_EVENTS){
+		handlers[event] = handler;
+	}
+}
+
+/*
+ * This function posts an event periodically. The first post happens one period
+ * from now. A period of 0 stops the timer.
+ * Inputs:
+ * 		event - event to post
+ * 		period_ms - time between posts in milliseconds
+ * Outputs:
+ * 		none
+ */
+void event_every(Event event, uint32_t period_ms){
+	if(event < NUM_EVENTS){
+		next_due[event] = get_time_ms() + period_ms;
+		periods[event] = period_ms;
+	}
+}
+
+/*
+ * This function marks an event as pending. It is safe to call from any
+ * interrupt. Posting an event that is already pending has no further effect.
+ * Inputs:
+ * 		event - event to post
+ * Outputs:
+ * 		none
+ */
+void event_post(Event event){
+	__atomic_fetch_or(&pending, 1u<<event, __ATOMIC_RELAXED);
+}
+
+/*
+ * This function runs the dispatch loop and never returns. Each pass posts any
+ * timers that are due, then runs the highest priority pending handler.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void event_run(){
+	while(1){
+		uint32_t start = DWT_CYCLES();
+		post_due_timers(get_time_ms());
+
+		uint32_t ready = pending;
+		if(ready == 0){
+			//an event posted between the check and WFI would sleep until the
+			//next interrupt, so check again masked, WFI still wakes on it
+			uint32_t primask = irq_save();
+			if(pending == 0){
+				loop_stats.idle++;
+				cpu_sleep();
+			}
+			irq_restore(primask);
+		}else{
+			//lowest set bit is the highest priority event
+			Event event = __builtin_ctz(ready);
+			__atomic_fetch_and(&pending, ~(1u<<event), __ATOMIC_RELAXED);
+			dispatch(event);
+		}
+
+		uint32_t cycles = DWT_CYCLES() - start;
+		loop_stats.iterations++;
+		if(cycles > loop_stats.max_cycles){
+			loop_stats.max_cycles = cycles;
+		}
+	}
+}
+
+/*
+ * This function copies the dispatch statistics of one event.
+ * Inputs:
+ * 		event - event to query
+ * 		*stats - where to store the statistics
+ * Outputs:
+ * 		none
+ */
+void event_get_stats(Event event, EventStats *stats){
+	if(event < NUM_EVENTS){
+		*stats = event_stats[event];
+	}
+}
+
+/*
+ * This function copies the statistics of the dispatch loop. The idle passes
+ * include time spent asleep waiting for an interrupt.
+ * Inputs:
+ * 		*stats - where to store the statistics
+ * Outputs:
+ * 		none
+ */
+void event_get_loop_stats(LoopStats *stats){
+	*stats = loop_stats;
+}
+
+/*
+ * This function clears all dispatch statistics.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void event_clear_stats(){
+	for(int i = 0; i < NUM_EVENTS; i++){
+		event_stats[i].count = 0;
+		event_stats[i].max_cycles = 0;
+		event_stats[i].total_cycles = 0;
+	}
+	loop_stats.iterations = 0;
+	loop_stats.idle = 0;
+	loop_stats.max_cycles = 0;
+}
+
+static void post_due_timers(uint32_t now){
+	for(int i = 0; i < NUM_EVENTS; i++){
+		//signed difference handles wrap of the millisecond tick
+		if(periods[i] != 0 && (int32_t)(now - next_due[i]) >= 0){
+			next_due[i] += periods[i];
+			event_post(i);
+		}
+	}
+}
+
+static void dispatch(Event event){
+	if(handlers[event] == 0){
+		return;
+	}
+
+	//the tasks event reposts itself while a protothread waits, trace it once
+	//per run of re-dispatches, every other event each time
+	static Event last_traced = NUM_EVENTS;
+	if(event != EVT_TASKS || last_traced != EVT_TASKS){
+		trace(TRACE_EVENT, event);
+	}
+	last_traced = event;
+	uint32_t start = DWT_CYCLES();
+	handlers[event]();
+	uint32_t cycles = DWT_CYCLES() - start;
+
+	EventStats *stats = &event_stats[event];
+	stats->count++;
+	stats->total_cycles += cycles;
+	if(cycles > stats->max_cycles){
+		stats->max_cycles = cycles;
+	}
+}
@@ -0,0 +1,265 @@
+/*
+ * evlog.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements an append only log of alarm, fault, reset and setting
+ * events in flash. Events are posted to a RAM buffer from any context and
+ * programmed later by evlog_flush(), a few records at a time, from a low
+ * priority handler. On boot the end of the log in each sector is found with a
+ * binary search for the first erased record, so recovery takes a few dozen
+ * flash reads no matter how full the log is.
+ *
+ * The log takes turns between two sectors. When the current one fills, the
+ * log moves on to the other, and the older records are only lost when that
+ * sector is erased, so the previous sector's worth always survives. A sector
+ * erase stalls the processor for a second or two, so it is only done by
+ * evlog_init(), before the control loop starts: once the current sector is half
+ * full, the other is erased ready for the move. If a sector fills at run time
+ * with no erased sector to move to, events wait in RAM and are dropped once the
+ * buffer is full.
+ */
+
+#include "evlog.h"
+#include "nvic.h"
+#include "timer.h"
+#include "cobs.h"
+
+static uint32_t buffer[EVLOG_BUFFER][EVLOG_RECORD_WORDS];
+static volatile uint32_t buf_head;		//next free buffer slot, written by evlog_post()
+static volatile uint32_t buf_tail;		//next slot to program, written by evlog_flush()
+static uint32_t next_seq;
+static uint8_t current;					//sector being written, 0 or 1
+static uint32_t count[2];				//records in each sector
+static uint32_t dropped;
+static EvlogFlushCallback flush_callback;
+
+static const uint8_t sector_num[2] = {EVLOG_SECTOR_A, EVLOG_SECTOR_B};
+static const uint32_t sector_addr[2] = {EVLOG_ADDR_A, EVLOG_ADDR_B};
+static const uint32_t sector_records[2] = {EVLOG_RECORDS_A, EVLOG_RECORDS_B};
+
+static uint32_t find_end(uint8_t sector);
+static int read_record(uint8_t sector, uint32_t index, EvlogRecord *record);
+static int newest_seq(uint8_t sector, uint32_t *seq);
+static const volatile uint32_t *record_addr(uint8_t sector, uint32_t index);
+static uint16_t record_crc(const uint32_t *words);
+
+/*
+ * This function finds the end of the log in both sectors and continues after
+ * the newest record in either. If the current sector is half full the other
+ * is erased, ready for the log to move on to it.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		number of records in flash, or -1 on a flash error
+ */
+int evlog_init(){
+	uint32_t seq[2];
+	int found[2];
+	for(uint8_t i = 0; i < 2; i++){
+		count[i] = find_end(i);
+		found[i] = newest_seq(i, &seq[i]);
+	}
+
+	//the sector holding the newest record is the one being written
+	if(found[0] && found[1]){
+		current = (int32_t)(seq[1] - seq[0]) > 0 ? 1 : 0;
+	}else{
+		current = found[1] ? 1 : 0;
+	}
+	next_seq = found[current] ? seq[current] + 1 : 0;
+	buf_head = buf_tail = 0;
+	dropped = 0;
+
+	uint8_t other = !current;
+	if(count[current] >= sector_records[current] / 2 && count[other] > 0){
+		if(flash_erase_sector(sector_num[other]) != 0){
+			return -1;
+		}
+		count[other] = 0;
+	}
+	return count[0] + count[1];
+}
+
+/*
+ * This function adds an event to the RAM buffer, stamped with the current time.
+ * It is safe to call from an interrupt. The event reaches flash on the next
+ * evlog_flush(), and the flush callback asks for one once EVLOG_FLUSH_LEVEL
+ * records are waiting. If the buffer is full the event is dropped, but still
+ * takes a sequence number so the loss shows as a gap in the log.
+ * Inputs:
+ * 		type - kind of event
+ * 		arg - small argument, depends on the type
+ * 		data - value, depends on the type
+ * Outputs:
+ * 		none
+ */
+void evlog_post(EvlogType type, uint8_t arg, int32_t data){
+	uint32_t primask = irq_save();
+	uint32_t waiting = buf_head - buf_tail;
+	if(waiting >= EVLOG_BUFFER){
+		dropped++;
+		next_seq++;
+	}else{
+		uint32_t *words = buffer[buf_head % EVLOG_BUFFER];
+		words[0] = next_seq++;
+		words[1] = get_time_ms();
+		words[2] = data;
+		words[3] = type | (arg << 8);
+		words[3] |= record_crc(words) << 16;
+		buf_head++;
+	}
+	irq_restore(primask);
+
+	if(waiting + 1 == EVLOG_FLUSH_LEVEL && flush_callback){
+		flush_callback();
+	}
+}
+
+/*
+ * This function sets a function called when the RAM buffer is half full. It may
+ * run in interrupt context and should only schedule an evlog_flush().
+ * Inputs:
+ * 		callback - function to call, 0 for none
+ * Outputs:
+ * 		none
+ */
+void evlog_set_flush_callback(EvlogFlushCallback callback){
+	flush_callback = callback;
+}
+
+/*
+ * This function programs the buffered events into flash, moving on to the
+ * other sector when the current one is full and the other is erased. It never
+ * erases, so if neither has room the events stay buffered until the next boot.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		number of records written, or -1 on a flash error
+ */
+int evlog_flush(){
+	int written = 0;
+	while(buf_tail != buf_head){
+		if(count[current] >= sector_records[current]){
+			if(count[!current] != 0){
+				break;
+			}
+			current = !current;
+		}
+
+		//the last word holds the CRC, so a torn record is never taken as valid
+		uint32_t addr = (uint32_t)(uintptr_t)record_addr(current, count[current]);
+		count[current]++;
+		if(flash_program(addr, buffer[buf_tail % EVLOG_BUFFER], EVLOG_RECORD_WORDS) != 0){
+			return -1;
+		}
+		buf_tail++;
+		written++;
+	}
+	return written;
+}
+
+/*
+ * This function reads a record back from flash, from the current sector and
+ * then the older one.
+ * Inputs:
+ * 		back - how many records before the newest, 0 for the newest
+ * 		*record - where to store the record
+ * Outputs:
+ * 		1 if the record exists and is intact, 0 otherwise
+ */
+int evlog_read(uint32_t back, EvlogRecord *record){
+	if(back < count[current]){
+		return read_record(current, count[current] - 1 - back, record);
+	}
+	back -= count[current];
+	if(back < count[!current]){
+		return read_record(!current, count[!current] - 1 - back, record);
+	}
+	return 0;
+}
+
+/*
+ * This function reports the state of the log.
+ * Inputs:
+ * 		*info - where to store the summary
+ * Outputs:
+ * 		none
+ */
+void evlog_get_info(EvlogInfo *info){
+	info->records = count[0] + count[1];
+	info->next_seq = next_seq;
+	info->pending = buf_head - buf_tail;
+	info->dropped = dropped;
+}
+
+/*
+ * Returns the number of records in a sector. Records are written in order, so
+ * the erased ones form the tail of the sector.
+ */
+static uint32_t find_end(uint8_t sector){
+	uint32_t lo = 0;
+	uint32_t hi = sector_records[sector];
+	while(lo < hi){
+		uint32_t mid = (lo + hi) / 2;
+		if(record_addr(sector, mid)[0] == FLASH_ERASED){
+			hi = mid;
+		}else{
+			lo = mid + 1;
+		}
+	}
+	return lo;
+}
+
+/*
+ * Finds the sequence number of the newest intact record in a sector. Returns 1
+ * if there is one.
+ */
+static int newest_seq(uint8_t sector, uint32_t *seq){
+	for(uint32_t i = count[sector]; i > 0; i--){
+		EvlogRecord record;
+		if(read_record(sector, i - 1, &record)){
+			*seq = record.seq;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Reads one record and checks its CRC. Returns 1 if it is intact.
+ */
+static int read_record(uint8_t sector, uint32_t index, EvlogRecord *record){
+	const volatile uint32_t *addr = record_addr(sector, index);
+	uint32_t words[EVLOG_RECORD_WORDS];
+	for(int i = 0; i < EVLOG_RECORD_WORDS; i++){
+		words[i] = addr[i];
+	}
+	if((words[3] >> 16) != record_crc(words)){
+		return 0;
+	}
+	record->seq = words[0];
+	record->time_ms = words[1];
+	record->data = words[2];
+	record->type = words[3] & 0xFF;
+	record->arg = (words[3] >> 8) & 0xFF;
+	return 1;
+}
+
+static const volatile uint32_t *record_addr(uint8_t sector, uint32_t index){
+	return (const volatile uint32_t*)(uintptr_t)(sector_addr[sector] + index * 4*EVLOG_RECORD_WORDS);
+}
+
+static uint16_t record_crc(const uint32_t *words){
+	uint8_t bytes[14];
+	for(int i = 0; i < 3; i++){
+		bytes[4*i] = words[i];
+		bytes[4*i+1] = words[i] >> 8;
+		bytes[4*i+2] = words[i] >> 16;
+		bytes[4*i+3] = words[i] >> 24;
+	}
+	bytes[12] = words[3];
+	bytes[13] = words[3] >> 8;
+	return crc16_ccitt(bytes, sizeof(bytes), 0xFFFF);
+}
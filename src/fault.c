@@ -0,0 +1,211 @@
+/*
+ * fault.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements the fault handlers. A HardFault, MemManage, BusFault,
+ * UsageFault or an interrupt with no handler turns every load off, saves the
+ * stacked registers, the fault status and address registers and a short call
+ * trace into a RAM record that start up does not clear, and resets the
+ * processor. The next boot finds the record, reports it and carries on, so a
+ * crash costs a few milliseconds instead of a power cycle with the gates left
+ * in whatever state they were in.
+ *
+ * The record is placed in the .noinit section, which LinkerScript.ld places in
+ * RAM as NOLOAD, outside .data and .bss.
+ */
+
+#include "fault.h"
+#include "pwm.h"
+#include "timer.h"
+#include "uart_driver.h"
+
+static FaultRecord record __attribute__((section(".noinit")));
+
+static void print_hex(const char *label, uint32_t value);
+
+//the host simulator raises no fault exceptions, so the handlers are left out of that build
+#ifndef SIM_HOST
+void fault_capture(uint32_t *frame, uint32_t exc_return) __attribute__((noreturn, used));
+static uint8_t in_sram(const uint32_t *addr, uint32_t words);
+
+/*
+ * Fault handler entry. Passes the stack the exception frame was pushed to, MSP
+ * or PSP as EXC_RETURN bit 2 tells, on to fault_capture(). The other fault
+ * vectors share it.
+ */
+__attribute__((naked)) void HardFault_Handler(){
+	__asm__ volatile(
+		"tst lr, #4\n\t"
+		"ite eq\n\t"
+		"mrseq r0, msp\n\t"
+		"mrsne r0, psp\n\t"
+		"mov r1, lr\n\t"
+		"b fault_capture\n\t"
+	);
+}
+void MemManage_Handler() __attribute__((alias("HardFault_Handler")));
+void BusFault_Handler() __attribute__((alias("HardFault_Handler")));
+void UsageFault_Handler() __attribute__((alias("HardFault_Handler")));
+#endif
+
+/*
+ * This function enables the MemManage, BusFault and UsageFault exceptions so
+ * each is reported with its own cause rather than escalating to a HardFault.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void fault_init(){
+	*(SCB_SHCSR) |= (1<<SCB_SHCSR_MEMFAULTENA_F) | (1<<SCB_SHCSR_BUSFAULTENA_F) | (1<<SCB_SHCSR_USGFAULTENA_F);
+}
+
+/*
+ * This function returns the crash record left by a fault before the last
+ * reset.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		the record, or 0 if there is none
+ */
+const FaultRecord *fault_get(){
+	if(record.magic != FAULT_MAGIC || record.check != ~FAULT_MAGIC){
+		return 0;
+	}
+	return &record;
+}
+
+/*
+ * This function marks the crash record as reported, so it is not reported
+ * again after later resets. It stays readable with fault_get().
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void fault_mark_reported(){
+	record.reported = 1;
+}
+
+/*
+ * This function prints a crash record to the console.
+ * Inputs:
+ * 		*fault - crash record
+ * Outputs:
+ * 		none
+ */
+void fault_print(const FaultRecord *fault){
+	static const char *names[] = {"hard", "memmanage", "bus", "usage"};
+	usart2_print_string("fault: ");
+	if(fault->type >= FAULT_HARD && fault->type <= FAULT_USAGE){
+		usart2_print_string(names[fault->type - FAULT_HARD]);
+	}else{
+		usart2_print_string("unexpected exception ");
+		usart2_print_num(fault->type);
+	}
+	usart2_print_string(" at ");
+	usart2_print_num(fault->time_ms);
+	usart2_print_string("ms\r\n");
+	print_hex("pc", fault->pc);
+	print_hex("lr", fault->lr);
+	print_hex("sp", fault->sp);
+	print_hex("psr", fault->psr);
+	print_hex("r0", fault->r0);
+	print_hex("r1", fault->r1);
+	print_hex("r2", fault->r2);
+	print_hex("r3", fault->r3);
+	print_hex("r12", fault->r12);
+	print_hex("cfsr", fault->cfsr);
+	print_hex("hfsr", fault->hfsr);
+	print_hex("mmfar", fault->mmfar);
+	print_hex("bfar", fault->bfar);
+	for(int i = 0; i < FAULT_TRACE_DEPTH && fault->trace[i] != 0; i++){
+		print_hex("trace", fault->trace[i]);
+	}
+}
+
+#ifndef SIM_HOST
+/*
+ * Saves the crash record and resets. Runs in handler mode with interrupts
+ * disabled. The loads are turned off first, before anything that could fault
+ * again. Stack memory is only read after checking it is in SRAM, since a stack
+ * overflow is a common cause of the fault.
+ */
+void fault_capture(uint32_t *frame, uint32_t exc_return){
+	__asm__ volatile("cpsid i");
+	pwm_force_off();
+
+	uint32_t ipsr;
+	__asm__ volatile("mrs %0, ipsr" : "=r"(ipsr));
+	record.magic = 0;
+	record.type = ipsr & 0x1FF;
+	record.exc_return = exc_return;
+	record.cfsr = *(SCB_CFSR);
+	record.hfsr = *(SCB_HFSR);
+	record.mmfar = *(SCB_MMFAR);
+	record.bfar = *(SCB_BFAR);
+	record.time_ms = get_time_ms();
+	record.reported = 0;
+
+	//the basic frame is 8 words, 26 when the FPU state was stacked(EXC_RETURN bit 4 clear)
+	uint32_t frame_words = (exc_return & (1<<4)) ? 8 : 26;
+	uint32_t *stacked = &record.r0;
+	if(in_sram(frame, frame_words)){
+		stacked[0] = frame[0];		//r0
+		stacked[1] = frame[1];		//r1
+		stacked[2] = frame[2];		//r2
+		stacked[3] = frame[3];		//r3
+		stacked[4] = frame[4];		//r12
+		record.lr = frame[5];
+		record.pc = frame[6];
+		record.psr = frame[7];
+		//an extra alignment word was stacked if PSR bit 9 is set
+		record.sp = (uint32_t)(uintptr_t)(frame + frame_words + ((frame[7] >> 9) & 1));
+	}else{
+		for(int i = 0; i < 5; i++){
+			stacked[i] = 0;
+		}
+		record.lr = record.pc = record.psr = 0;
+		record.sp = (uint32_t)(uintptr_t)frame;
+	}
+
+	//return addresses are odd(Thumb) words in the code region, the best a handler can do without unwind tables
+	uint32_t found = 0;
+	uint32_t *scan = (uint32_t*)(uintptr_t)record.sp;
+	for(uint32_t i = 0; i < FAULT_SCAN_WORDS && found < FAULT_TRACE_DEPTH && in_sram(scan + i, 1); i++){
+		uint32_t word = scan[i];
+		if((word & 1) && word >= FAULT_CODE_START && word < FAULT_CODE_END){
+			record.trace[found++] = word & ~1u;
+		}
+	}
+	while(found < FAULT_TRACE_DEPTH){
+		record.trace[found++] = 0;
+	}
+
+	record.check = ~FAULT_MAGIC;
+	record.magic = FAULT_MAGIC;
+	__asm__ volatile("dsb");
+	*(SCB_AIRCR) = SCB_AIRCR_RESET;
+	__asm__ volatile("dsb");
+	while(1);
+}
+
+static uint8_t in_sram(const uint32_t *addr, uint32_t words){
+	uint32_t start = (uint32_t)(uintptr_t)addr;
+	return start >= FAULT_SRAM_START && start + 4*words <= FAULT_SRAM_END && (start & 3) == 0;
+}
+#endif
+
+static void print_hex(const char *label, uint32_t value){
+	char text[11] = "0x";
+	for(int i = 0; i < 8; i++){
+		text[2+i] = "0123456789ABCDEF"[(value >> (28 - 4*i)) & 0xF];
+	}
+	text[10] = '\0';
+	usart2_print_string(label);
+	usart2_print_string(" ");
+	usart2_print_string(text);
+	usart2_print_string("\r\n");
+}
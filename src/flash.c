@@ -0,0 +1,85 @@
+/*
+ * flash.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements sector erase and word programming of the internal flash.
+ * The flash has a single bank, so instruction fetches stall while it is busy:
+ * a word program takes about 16us, but a 128KB sector erase stalls the whole
+ * processor, interrupts included, for one to two seconds. Callers keep erases
+ * out of the normal control path.
+ */
+
+#include "flash.h"
+
+static void unlock();
+static void lock();
+static int wait_done();
+
+/*
+ * This function erases one flash sector.
+ * Inputs:
+ * 		sector - sector number
+ * Outputs:
+ * 		0 on success, -1 if the flash reported an error
+ */
+int flash_erase_sector(uint8_t sector){
+	//the erase stalls the core for up to 2s, start it with a full watchdog timeout
+	watchdog_reload();
+	unlock();
+	*(FLASH_CR) = (FLASH_CR_PSIZE_X32<<FLASH_CR_PSIZE_F) | (1<<FLASH_CR_SER_F) | (sector<<FLASH_CR_SNB_F);
+	*(FLASH_CR) |= (1<<FLASH_CR_STRT_F);
+	int result = wait_done();
+	*(FLASH_CR) &= ~((1<<FLASH_CR_SER_F) | (0xF<<FLASH_CR_SNB_F));
+	lock();
+
+	//the data cache may still hold words from before the erase
+	if(*(FLASH_ACR) & (1<<FLASH_ACR_DCEN_F)){
+		*(FLASH_ACR) &= ~(1<<FLASH_ACR_DCEN_F);
+		*(FLASH_ACR) |= (1<<FLASH_ACR_DCRST_F);
+		*(FLASH_ACR) &= ~(1<<FLASH_ACR_DCRST_F);
+		*(FLASH_ACR) |= (1<<FLASH_ACR_DCEN_F);
+	}
+	return result;
+}
+
+/*
+ * This function programs words into erased flash, in order.
+ * Inputs:
+ * 		addr - word aligned flash address
+ * 		*words - data to program
+ * 		count - number of words
+ * Outputs:
+ * 		0 on success, -1 if the flash reported an error
+ */
+int flash_program(uint32_t addr, const uint32_t *words, uint32_t count){
+	int result = 0;
+	unlock();
+	*(FLASH_CR) = (FLASH_CR_PSIZE_X32<<FLASH_CR_PSIZE_F) | (1<<FLASH_CR_PG_F);
+	for(uint32_t i = 0; i < count && result == 0; i++){
+		*(volatile uint32_t*)(uintptr_t)(addr + 4*i) = words[i];
+		result = wait_done();
+	}
+	*(FLASH_CR) &= ~(1<<FLASH_CR_PG_F);
+	lock();
+	return result;
+}
+
+static void unlock(){
+	if(*(FLASH_CR) & (1<<FLASH_CR_LOCK_F)){
+		*(FLASH_KEYR) = FLASH_KEY1;
+		*(FLASH_KEYR) = FLASH_KEY2;
+	}
+	//clear errors left by an earlier operation
+	*(FLASH_SR) = FLASH_SR_ERRORS | (1<<FLASH_SR_EOP_F);
+}
+
+static void lock(){
+	*(FLASH_CR) |= (1<<FLASH_CR_LOCK_F);
+}
+
+static int wait_done(){
+	while(*(FLASH_SR) & (1<<FLASH_SR_BSY_F));
+	return (*(FLASH_SR) & FLASH_SR_ERRORS) ? -1 : 0;
+}
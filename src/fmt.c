@@ -0,0 +1,126 @@
+/*
+ * fmt.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements the little text formatting the display needs, without
+ * the C library's printf family. Each function appends to a fixed size buffer
+ * at a position, keeps it null terminated, truncates rather than overflowing,
+ * and returns the new position so calls can be chained.
+ */
+
+#include "fmt.h"
+
+static uint32_t put(char *buf, uint32_t size, uint32_t pos, char c);
+static uint32_t pad(char *buf, uint32_t size, uint32_t pos, uint32_t len, uint8_t width);
+
+/*
+ * This function appends a string.
+ * Inputs:
+ * 		*buf - buffer
+ * 		size - size of the buffer, including the null terminator
+ * 		pos - position to append at
+ * 		*str - null terminated string
+ * Outputs:
+ * 		position after the appended text
+ */
+uint32_t fmt_str(char *buf, uint32_t size, uint32_t pos, const char *str){
+	while(*str != '\0'){
+		pos = put(buf, size, pos, *str++);
+	}
+	return pos;
+}
+
+/*
+ * This function appends a decimal integer, right aligned in a field.
+ * Inputs:
+ * 		*buf - buffer
+ * 		size - size of the buffer, including the null terminator
+ * 		pos - position to append at
+ * 		value - number to append
+ * 		width - minimum field width, padded with spaces on the left
+ * Outputs:
+ * 		position after the appended text
+ */
+uint32_t fmt_int(char *buf, uint32_t size, uint32_t pos, int32_t value, uint8_t width){
+	char digits[11];
+	uint32_t magnitude = value < 0 ? -(uint32_t)value : (uint32_t)value;
+	uint32_t count = 0;
+	do{
+		digits[count++] = '0' + magnitude % 10;
+		magnitude /= 10;
+	}while(magnitude != 0);
+
+	pos = pad(buf, size, pos, count + (value < 0), width);
+	if(value < 0){
+		pos = put(buf, size, pos, '-');
+	}
+	while(count > 0){
+		pos = put(buf, size, pos, digits[--count]);
+	}
+	return pos;
+}
+
+/*
+ * This function appends a number given in thousandths as a decimal with 0 to 3
+ * fraction digits, rounded to the nearest, right aligned in a field.
+ * Inputs:
+ * 		*buf - buffer
+ * 		size - size of the buffer, including the null terminator
+ * 		pos - position to append at
+ * 		milli - number in thousandths
+ * 		decimals - fraction digits, 0 to 3
+ * 		width - minimum field width, padded with spaces on the left
+ * Outputs:
+ * 		position after the appended text
+ */
+uint32_t fmt_milli(char *buf, uint32_t size, uint32_t pos, int32_t milli, uint8_t decimals, uint8_t width){
+	static const uint16_t scale[4] = {1000, 100, 10, 1};
+	if(decimals > 3){
+		decimals = 3;
+	}
+
+	uint32_t unit = scale[decimals];
+	uint32_t magnitude = milli < 0 ? -(uint32_t)milli : (uint32_t)milli;
+	magnitude = (magnitude + unit/2) / unit;		//in units of the last digit shown
+	uint32_t frac_scale = 1000 / unit;
+	uint32_t whole = magnitude / frac_scale;
+	uint32_t frac = magnitude % frac_scale;
+	uint8_t negative = milli < 0 && magnitude != 0;
+
+	//length of the whole part, sign, point and fraction
+	uint32_t len = 1;
+	for(uint32_t w = whole; w >= 10; w /= 10){
+		len++;
+	}
+	len += negative + (decimals ? decimals + 1 : 0);
+
+	pos = pad(buf, size, pos, len, width);
+	if(negative){
+		pos = put(buf, size, pos, '-');
+	}
+	pos = fmt_int(buf, size, pos, whole, 0);
+	if(decimals){
+		pos = put(buf, size, pos, '.');
+		for(uint32_t digit = frac_scale / 10; digit > 0; digit /= 10){
+			pos = put(buf, size, pos, '0' + (frac / digit) % 10);
+		}
+	}
+	return pos;
+}
+
+static uint32_t put(char *buf, uint32_t size, uint32_t pos, char c){
+	if(pos + 1 < size){
+		buf[pos++] = c;
+		buf[pos] = '\0';
+	}
+	return pos;
+}
+
+static uint32_t pad(char *buf, uint32_t size, uint32_t pos, uint32_t len, uint8_t width){
+	for(; len < width; len++){
+		pos = put(buf, size, pos, ' ');
+	}
+	return pos;
+}
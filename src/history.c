@@ -0,0 +1,238 @@
+/*
+ * history.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements a compressed history of temperature samples in SRAM.
+ * Each sample is stored as its difference from the previous one, so a steady
+ * 1Hz stream costs one byte per sample and 8KB holds a little over two hours.
+ * Samples are kept in fixed size blocks that each start with an absolute sample,
+ * so the oldest block can be dropped in constant time when the store is full and
+ * every block can be decoded on its own.
+ */
+
+#include <string.h>
+#include "history.h"
+#include "nvic.h"
+#include "uart_driver.h"
+
+static uint8_t store[HISTORY_BLOCKS][HISTORY_BLOCK_SIZE];
+static uint16_t used[HISTORY_BLOCKS];
+static uint16_t block_samples[HISTORY_BLOCKS];
+static uint32_t oldest;			//block number of the oldest block, counts up forever
+static uint32_t newest;			//block number being appended to
+static uint32_t oldest_time;
+static uint32_t last_time;
+static int16_t last_temp;
+static uint32_t samples;
+static uint32_t dropped;
+static uint8_t started;
+
+static void open_block(uint32_t time_s, int16_t temp_tenths);
+static uint8_t put_varint(uint8_t *p, uint32_t value);
+static uint8_t get_varint(const uint8_t *p, uint32_t len, uint32_t *value);
+
+//zigzag maps small signed values to small unsigned values: 0,-1,1,-2 -> 0,1,2,3
+#define ZIGZAG(v)	((uint32_t)(((v) << 1) ^ ((v) >> 31)))
+#define UNZIGZAG(u)	((int32_t)((u) >> 1) ^ -(int32_t)((u) & 1))
+
+/*
+ * This function empties the history.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void history_init(){
+	uint32_t primask = irq_save();
+	oldest = newest = 0;
+	samples = dropped = 0;
+	started = 0;
+	irq_restore(primask);
+}
+
+/*
+ * This function appends a sample to the history in constant time. It is safe to
+ * call from an interrupt. Samples must be appended in time order.
+ * Inputs:
+ * 		time_s - time of the sample in seconds
+ * 		temp_tenths - temperature in tenths of a degree Ferenheit
+ * Outputs:
+ * 		none
+ */
+void history_append(uint32_t time_s, int16_t temp_tenths){
+	uint8_t record[1 + 5 + 5];
+	uint8_t len;
+
+	uint32_t primask = irq_save();
+
+	uint32_t dt = time_s - last_time;
+	int32_t dv = temp_tenths - last_temp;
+	if(dt == 1 && dv >= -64 && dv <= 63){
+		record[0] = ZIGZAG(dv);
+		len = 1;
+	}else{
+		record[0] = HISTORY_ESCAPE;
+		len = 1 + put_varint(&record[1], dt);
+		len += put_varint(&record[len], ZIGZAG(dv));
+	}
+
+	uint32_t slot = newest % HISTORY_BLOCKS;
+	if(!started || used[slot] + len > HISTORY_BLOCK_SIZE){
+		open_block(time_s, temp_tenths);
+	}else{
+		memcpy(&store[slot][used[slot]], record, len);
+		used[slot] += len;
+		block_samples[slot]++;
+		samples++;
+	}
+
+	last_time = time_s;
+	last_temp = temp_tenths;
+	irq_restore(primask);
+}
+
+/*
+ * This function reports how much history is held.
+ * Inputs:
+ * 		*info - where to store the summary
+ * Outputs:
+ * 		none
+ */
+void history_get_info(HistoryInfo *info){
+	uint32_t primask = irq_save();
+	info->samples = samples;
+	info->bytes = 0;
+	for(uint32_t block = oldest; started && block <= newest; block++){
+		info->bytes += used[block % HISTORY_BLOCKS];
+	}
+	info->oldest_s = oldest_time;
+	info->newest_s = last_time;
+	info->dropped = dropped;
+	irq_restore(primask);
+}
+
+/*
+ * Protothread that writes the whole history to the console as CSV lines of
+ * time in seconds and temperature, oldest first. Each block is copied out with
+ * interrupts disabled and then decoded, waiting for room in the transmit buffer
+ * before each line, so a dump of any size never drops output or blocks other
+ * work. Blocks dropped while the dump is running are skipped.
+ * Inputs:
+ * 		*pt - protothread state
+ * Outputs:
+ * 		protothread state
+ */
+PT_THREAD(history_dump_pt(PT *pt)){
+	static uint8_t copy[HISTORY_BLOCK_SIZE];
+	static uint32_t block;
+	static uint16_t len;
+	static uint16_t pos;
+	static uint32_t time_s;
+	static int32_t temp;
+
+	PT_BEGIN(pt);
+	usart2_print_string("\r\ntime_s,temp_F\r\n");		//after the shell prompt
+	block = oldest;
+
+	while(started && (int32_t)(newest - block) >= 0){
+		//copy the block, skipping ahead if it has been dropped
+		{
+			uint32_t primask = irq_save();
+			if((int32_t)(block - oldest) < 0){
+				block = oldest;
+			}
+			len = used[block % HISTORY_BLOCKS];
+			memcpy(copy, store[block % HISTORY_BLOCKS], len);
+			irq_restore(primask);
+		}
+
+		time_s = copy[0] | (copy[1] << 8) | (copy[2] << 16) | ((uint32_t)copy[3] << 24);
+		temp = (int16_t)(copy[4] | (copy[5] << 8));
+		pos = HISTORY_HEADER_SIZE;
+
+		while(1){
+			PT_WAIT_UNTIL(pt, usart2_tx_free() >= 24);
+			usart2_print_num(time_s);
+			usart2_print_string(temp < 0 ? ",-" : ",");
+			usart2_print_num((temp < 0 ? -temp : temp) / 10);
+			usart2_print_string(".");
+			usart2_print_num((temp < 0 ? -temp : temp) % 10);
+			usart2_print_string("\r\n");
+
+			if(pos >= len){
+				break;
+			}
+			uint32_t dt = 1;
+			uint32_t zz;
+			if(copy[pos] != HISTORY_ESCAPE){
+				zz = copy[pos++];
+			}else{
+				pos++;
+				pos += get_varint(&copy[pos], len - pos, &dt);
+				pos += get_varint(&copy[pos], len - pos, &zz);
+			}
+			time_s += dt;
+			temp += UNZIGZAG(zz);
+		}
+		block++;
+	}
+	PT_END(pt);
+}
+
+/*
+ * Starts a new block with an absolute sample, dropping the oldest block if the
+ * store is full.
+ */
+static void open_block(uint32_t time_s, int16_t temp_tenths){
+	if(started){
+		newest++;
+	}
+	if(newest - oldest >= HISTORY_BLOCKS){
+		uint32_t slot = oldest % HISTORY_BLOCKS;
+		samples -= block_samples[slot];
+		dropped += block_samples[slot];
+		oldest++;
+		oldest_time = store[oldest % HISTORY_BLOCKS][0] | (store[oldest % HISTORY_BLOCKS][1] << 8)
+				| (store[oldest % HISTORY_BLOCKS][2] << 16) | ((uint32_t)store[oldest % HISTORY_BLOCKS][3] << 24);
+	}else if(!started){
+		oldest_time = time_s;
+	}
+
+	uint8_t *p = store[newest % HISTORY_BLOCKS];
+	p[0] = time_s;
+	p[1] = time_s >> 8;
+	p[2] = time_s >> 16;
+	p[3] = time_s >> 24;
+	p[4] = temp_tenths;
+	p[5] = temp_tenths >> 8;
+	used[newest % HISTORY_BLOCKS] = HISTORY_HEADER_SIZE;
+	block_samples[newest % HISTORY_BLOCKS] = 1;
+	samples++;
+	started = 1;
+}
+
+static uint8_t put_varint(uint8_t *p, uint32_t value){
+	uint8_t len = 0;
+	while(value >= 0x80){
+		p[len++] = (value & 0x7F) | 0x80;
+		value >>= 7;
+	}
+	p[len++] = value;
+	return len;
+}
+
+static uint8_t get_varint(const uint8_t *p, uint32_t len, uint32_t *value){
+	uint32_t result = 0;
+	uint8_t i = 0;
+	for(; i < len && i < 5; i++){
+		result |= (uint32_t)(p[i] & 0x7F) << (7*i);
+		if((p[i] & 0x80) == 0){
+			i++;
+			break;
+		}
+	}
+	*value = result;
+	return i;
+}
@@ -13,10 +13,20 @@
 const char keys[] = "123A456B789C*0#D";
 const int integers[] = {1,2,3,10,4,5,6,11,7,8,9,12,14,0,15,13};
 
-static void setRows_clearCol();
-static void setCol_clearRows();
-static uint8_t getRow(uint8_t rows);
-static uint8_t getCol(uint8_t cols);
+/*
+ * Decode table for a 4 bit row or column nibble read from the keypad. Only
+ * encodings with exactly one line pulled low decode to a line number(1-4),
+ * everything else(no key, or several keys on the same phase) decodes to 0.
+ */
+static const uint8_t line_decode[16] = {
+	0, 0, 0, 0, 0, 0, 0, 4,		//0b0000 - 0b0111
+	0, 0, 0, 3, 0, 2, 1, 0		//0b1000 - 0b1111
+};
+
+static inline void setRows_clearCol();
+static inline void setCol_clearRows();
+static inline void key_settle();
+static uint8_t key_released();
 
 /*
  * This function initializes the keyboard by enabling the clock the keyboard
@@ -54,14 +64,16 @@ void key_init(){
  */
 uint8_t key_getkey_noblock(){
 	setRows_clearCol();								//read coloumns, write rows
-	uint8_t cols = (*(GPIOC_IDR) &= 0b1111);		//save the column encoding
+	key_settle();
+	uint8_t cols = *(GPIOC_IDR) & 0x0F;				//save the column encoding
 	setCol_clearRows();								//switch to read rows, write columns
-	uint8_t rows = ((*(GPIOC_IDR) &= 0xF0) >> 4);	//save the row encoding
+	key_settle();
+	uint8_t rows = (*(GPIOC_IDR) >> 4) & 0x0F;		//save the row encoding
 	
-	uint8_t row = getRow(rows);						//get the int representation of the row
-	uint8_t col = getCol(cols);						//get the int representation of the col
+	uint8_t row = line_decode[rows];				//get the int representation of the row
+	uint8_t col = line_decode[cols];				//get the int representation of the col
 	
-	if(row*col == 0){
+	if(row == 0 || col == 0){
 		return 0;									//If no key is pressed, return 0
 	}else{
 		return ((row-1)*4)+col;						//return the number associated with key(1-16)
@@ -78,17 +90,12 @@ uint8_t key_getkey_noblock(){
  * 		number 1-16 corresponding to key pressed. See previous funtion for description.
  */
 uint8_t key_getkey(){
-	setRows_clearCol();								//read coloumns, write rows
-	while((*(GPIOC_IDR) &= 0b1111) == 0b1111){}		//wait until column detected
-	uint8_t cols = (*(GPIOC_IDR) &= 0b1111);		//save the column encoding
-	setCol_clearRows();								//switch to read rows, write columns
-	uint8_t rows = ((*(GPIOC_IDR) &= 0xF0) >> 4);	//save the row encoding
-	while(((*(GPIOC_IDR) &= 0xF0) >> 4) == rows){}	//wait until key is released.
+	uint8_t key;
+	while((key = key_getkey_noblock()) == 0){}		//wait until a single key is detected
 	
-	uint8_t row = getRow(rows);						//get the int representation of the row
-	uint8_t col = getCol(cols);						//get the int representation of the col
+	while(!key_released()){}						//wait until key is released.
 	
-	return ((row-1)*4)+col;							//return the number associated with key(1-16)	
+	return key;										//return the number associated with key(1-16)	
 }
 
 /*
@@ -137,82 +144,41 @@ uint8_t key_getint(){
 }
 
 
-static void setRows_clearCol(){
-	//set the rows to output mode
-	for(int i=4;i<=7;i++){
-		set_pin_mode('C',i,OUTPUT);
-	}
-	
-	//set columns to input
-	for(int i=0;i<=3;i++){
-		set_pin_mode('C',i,INPUT);
-	}
+/*
+ * Switches the keypad to the column read phase. Rows(PC4-7) become outputs
+ * driving 0 and columns(PC0-3) become pulled up inputs. Both directions are
+ * changed with a single masked write to the mode register.
+ */
+static inline void setRows_clearCol(){
+	*(GPIOC_MODER) = (*(GPIOC_MODER) & ~KEY_MODER_MASK) | KEY_MODER_ROWS_OUT;
 }
 
-static void setCol_clearRows(){
-	//set the rows to input mode
-	for(int i=4;i<=7;i++){
-		set_pin_mode('C',i,INPUT);
-	}
-	
-	//set columns to output
-	for(int i=0;i<=3;i++){
-		set_pin_mode('C',i,OUTPUT);
-	}
+/*
+ * Switches the keypad to the row read phase. Columns(PC0-3) become outputs
+ * driving 0 and rows(PC4-7) become pulled up inputs.
+ */
+static inline void setCol_clearRows(){
+	*(GPIOC_MODER) = (*(GPIOC_MODER) & ~KEY_MODER_MASK) | KEY_MODER_COLS_OUT;
 }
 
-static uint8_t getRow(uint8_t rows){
-	uint8_t row = -1;
-	
-	//return row number corresponding to the row encoding
-	switch(rows){
-		case 0b1111:
-			row=0;
-			break;
-		case 0b1110:
-			row=1;
-			break;
-		case 0b1101:
-			row=2;
-			break;
-		case 0b1011:
-			row=3;
-			break;
-		case 0b0111:
-			row=4;
-			break;
-		default:
-			row=0;
-			break;			
+/*
+ * Gives the pull ups KEY_SETTLE_NS to bring released lines back high after the
+ * direction of the port changes, before the input register is sampled. The
+ * loop is counted rather than timed with DWT so it also runs in the benchmark
+ * build, and each pass takes at least KEY_LOOP_CYCLES, so it is never shorter.
+ */
+static inline void key_settle(){
+	for(uint32_t i=0;i<KEY_SETTLE_LOOPS;i++){
+		__asm__ volatile("nop");
 	}
-	
-	return row;
 }
 
-static uint8_t getCol(uint8_t cols){
-	int col = -1;
-	
-	//return column corresponding to column encoding
-	switch(cols){
-		case 0b1111:
-			col=0;
-			break;
-		case 0b1110:
-			col=1;
-			break;
-		case 0b1101:
-			col=2;
-			break;
-		case 0b1011:
-			col=3;
-			break;
-		case 0b0111:
-			col=4;
-			break;
-		default:
-			col=0;
-			break;			
-	}
-	
-	return col;
+/*
+ * Reports whether all keys are released, by driving the columns low and
+ * checking that every row reads high.
+ */
+static uint8_t key_released(){
+	setCol_clearRows();
+	key_settle();
+	return (*(GPIOC_IDR) & 0xF0) == 0xF0;
 }
@@ -0,0 +1,320 @@
+/*
+ * kv_store.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements a small key/value store in flash for settings that must
+ * survive a reset. Values live in a RAM table, and kv_set() only marks a key as
+ * changed; kv_commit() appends the changed keys to the active sector later, so
+ * callers in the control path never wait on flash. Appending spreads wear over
+ * the whole sector, and when it fills the live values are copied to the other
+ * sector. A record torn by a power loss fails its CRC and is skipped, and an
+ * interrupted copy never gets its header, so the store always loads either the
+ * old or the new value.
+ *
+ * A sector erase stalls the processor for a second or two, so sectors are only
+ * erased by kv_init(), before the control loop starts. It leaves the spare
+ * sector erased, and a copy at run time only programs it. After a copy the old
+ * sector is not erased until the next boot, so if the new sector also fills
+ * before then, changes wait in RAM.
+ */
+
+#include "kv_store.h"
+#include "cobs.h"
+
+static uint16_t keys[KV_MAX_KEYS];
+static int32_t values[KV_MAX_KEYS];
+static uint32_t dirty;				//bit n set when values[n] has not been written
+static uint8_t num_keys;
+static uint8_t active;				//0 for sector A, 1 for sector B
+static uint32_t write_offset;		//next free record in the active sector
+static uint32_t generation;
+static uint32_t bad_records;
+static uint8_t spare_ready;			//the other sector is erased
+
+static const uint8_t sector_num[2] = {KV_SECTOR_A, KV_SECTOR_B};
+static const uint32_t sector_addr[2] = {KV_SECTOR_A_ADDR, KV_SECTOR_B_ADDR};
+
+static uint16_t record_crc(uint16_t key, int32_t value);
+static int read_record(uint32_t addr, uint16_t *key, int32_t *value);
+static int find(uint16_t key);
+static int store(uint16_t key, int32_t value);
+static int program_record(uint32_t addr, uint16_t key, int32_t value);
+static int append(uint16_t key, int32_t value);
+static int compact();
+static int prepare_spare();
+
+/*
+ * This function loads the store with one pass over the active sector. If
+ * neither sector holds a valid store, sector A is started empty. The spare
+ * sector is then erased unless it already is, so call this before anything
+ * that cannot wait a couple of seconds is running.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		number of keys loaded, or -1 if the flash could not be prepared
+ */
+int kv_init(){
+	uint16_t key;
+	int32_t value;
+	uint8_t valid[2];
+	uint32_t gen[2];
+
+	num_keys = 0;
+	dirty = 0;
+	bad_records = 0;
+	for(int i = 0; i < 2; i++){
+		valid[i] = read_record(sector_addr[i], &key, &value) == 0 && key == KV_HEADER_KEY;
+		gen[i] = value;
+	}
+
+	if(!valid[0] && !valid[1]){
+		//start an empty store in sector A
+		active = 1;
+		generation = 0;
+		if(prepare_spare() != 0 || compact() != 0){
+			return -1;
+		}
+	}else{
+		active = (valid[1] && (!valid[0] || (int32_t)(gen[1] - gen[0]) > 0)) ? 1 : 0;
+		generation = gen[active];
+
+		//replay the log, stopping at the first erased record
+		uint32_t base = sector_addr[active];
+		for(write_offset = KV_RECORD_SIZE; write_offset < FLASH_SECTOR_SIZE; write_offset += KV_RECORD_SIZE){
+			const volatile uint32_t *record = (const volatile uint32_t*)(uintptr_t)(base + write_offset);
+			if(record[0] == FLASH_ERASED && record[1] == FLASH_ERASED){
+				break;
+			}
+			if(read_record(base + write_offset, &key, &value) != 0 || key == KV_HEADER_KEY){
+				bad_records++;
+				continue;
+			}
+			store(key, value);
+		}
+		dirty = 0;
+	}
+	return prepare_spare() == 0 ? num_keys : -1;
+}
+
+/*
+ * This function looks up a key.
+ * Inputs:
+ * 		key - key to look up
+ * 		*value - where to store the value
+ * Outputs:
+ * 		1 if the key was found, 0 otherwise
+ */
+int kv_get(uint16_t key, int32_t *value){
+	int i = find(key);
+	if(i < 0){
+		return 0;
+	}
+	*value = values[i];
+	return 1;
+}
+
+/*
+ * This function changes a key in RAM. The change reaches flash on the next
+ * kv_commit(), and setting a key to its current value costs nothing.
+ * Inputs:
+ * 		key - key to set, not KV_HEADER_KEY or 0xFFFF
+ * 		value - new value
+ * Outputs:
+ * 		0 on success, -1 if the key is reserved or the table is full
+ */
+int kv_set(uint16_t key, int32_t value){
+	if(key >= KV_HEADER_KEY){
+		return -1;
+	}
+	return store(key, value);
+}
+
+/*
+ * This function writes every changed key to flash. It is meant to run from a
+ * low priority handler, batching the changes since the last call. If the
+ * active sector is full the live values are copied to the erased spare sector.
+ * If the spare was already used since boot, the changes stay pending until the
+ * next boot has erased it.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		number of keys written, or -1 on a flash error
+ */
+int kv_commit(){
+	int written = 0;
+	for(int i = 0; i < num_keys; i++){
+		if(dirty & (1u<<i)){
+			if(write_offset + KV_RECORD_SIZE > FLASH_SECTOR_SIZE){
+				if(!spare_ready){
+					return written;
+				}
+				return compact() == 0 ? num_keys : -1;
+			}
+			if(append(keys[i], values[i]) != 0){
+				return -1;
+			}
+			dirty &= ~(1u<<i);
+			written++;
+		}
+	}
+	return written;
+}
+
+/*
+ * This function returns the number of changed keys waiting for kv_commit().
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		number of keys
+ */
+uint32_t kv_pending(){
+	return __builtin_popcount(dirty);
+}
+
+/*
+ * This function forgets every key, in RAM and in flash, by starting an empty
+ * store in the spare sector. Nothing is erased, so it is refused when the spare
+ * was already used since boot.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		0 on success, -1 on a flash error or without an erased spare
+ */
+int kv_erase(){
+	if(!spare_ready){
+		return -1;
+	}
+	num_keys = 0;
+	dirty = 0;
+	return compact();
+}
+
+/*
+ * This function reports the state of the store.
+ * Inputs:
+ * 		*info - where to store the summary
+ * Outputs:
+ * 		none
+ */
+void kv_get_info(KvInfo *info){
+	info->keys = num_keys;
+	info->pending = kv_pending();
+	info->used = write_offset;
+	info->generation = generation;
+	info->bad = bad_records;
+	info->spare = spare_ready;
+}
+
+static uint16_t record_crc(uint16_t key, int32_t value){
+	uint8_t bytes[6] = {key, key >> 8, value, value >> 8, value >> 16, value >> 24};
+	return crc16_ccitt(bytes, sizeof(bytes), 0xFFFF);
+}
+
+/*
+ * Reads and checks one record. Returns 0 if the CRC matches.
+ */
+static int read_record(uint32_t addr, uint16_t *key, int32_t *value){
+	const volatile uint32_t *record = (const volatile uint32_t*)(uintptr_t)addr;
+	uint32_t word0 = record[0];
+	*key = word0 & 0xFFFF;
+	*value = record[1];
+	return (word0 >> 16) == record_crc(*key, *value) ? 0 : -1;
+}
+
+static int find(uint16_t key){
+	for(int i = 0; i < num_keys; i++){
+		if(keys[i] == key){
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*
+ * Updates the RAM table, marking the key changed if its value differs.
+ */
+static int store(uint16_t key, int32_t value){
+	int i = find(key);
+	if(i < 0){
+		if(num_keys >= KV_MAX_KEYS){
+			return -1;
+		}
+		i = num_keys++;
+		keys[i] = key;
+	}else if(values[i] == value){
+		return 0;
+	}
+	values[i] = value;
+	dirty |= (1u<<i);
+	return 0;
+}
+
+/*
+ * Programs one record into erased flash and reads it back. The value is
+ * programmed first so a record only passes its CRC once both words are written.
+ */
+static int program_record(uint32_t addr, uint16_t key, int32_t value){
+	uint32_t word0 = key | (record_crc(key, value) << 16);
+	uint16_t read_key;
+	int32_t read_value;
+	if(flash_program(addr + 4, (const uint32_t*)&value, 1) != 0
+			|| flash_program(addr, &word0, 1) != 0
+			|| read_record(addr, &read_key, &read_value) != 0){
+		return -1;
+	}
+	return (read_key == key && read_value == value) ? 0 : -1;
+}
+
+/*
+ * Appends one record to the active sector.
+ */
+static int append(uint16_t key, int32_t value){
+	uint32_t addr = sector_addr[active] + write_offset;
+	write_offset += KV_RECORD_SIZE;
+	return program_record(addr, key, value);
+}
+
+/*
+ * Copies every live value to the erased spare sector, then its header, and
+ * switches to it once all of it reads back. On a failure the old sector stays
+ * active and the spare waits for the next boot to be erased again.
+ */
+static int compact(){
+	uint32_t base = sector_addr[!active];
+	uint32_t offset = KV_RECORD_SIZE;
+	spare_ready = 0;
+	for(int i = 0; i < num_keys; i++, offset += KV_RECORD_SIZE){
+		if(program_record(base + offset, keys[i], values[i]) != 0){
+			return -1;
+		}
+	}
+	if(program_record(base, KV_HEADER_KEY, generation + 1) != 0){
+		return -1;
+	}
+	active = !active;
+	write_offset = offset;
+	generation++;
+	dirty = 0;
+	return 0;
+}
+
+/*
+ * Erases the spare sector unless it is already blank, which stalls the
+ * processor for a second or two.
+ */
+static int prepare_spare(){
+	const volatile uint32_t *word = (const volatile uint32_t*)(uintptr_t)sector_addr[!active];
+	spare_ready = 0;
+	for(uint32_t i = 0; i < FLASH_SECTOR_SIZE / 4; i++){
+		if(word[i] != FLASH_ERASED){
+			if(flash_erase_sector(sector_num[!active]) != 0){
+				return -1;
+			}
+			break;
+		}
+	}
+	spare_ready = 1;
+	return 0;
+}
@@ -14,6 +14,15 @@ void static set_lower_nibble(uint8_t command);
 void static latch();
 void static lcd_execute(uint8_t command);
 void static poll_busy();
+static void set_busy_read_mode();
+static uint8_t read_busy();
+static void send(uint8_t command);
+static PT_THREAD(lcd_execute_pt(PT *pt, uint8_t command));
+
+//state shared by the LCD protothreads, only one may run at a time
+static PT lcd_child;
+static const char *lcd_next;
+static uint32_t lcd_wait_start;
 
 
 
@@ -222,7 +231,76 @@ void lcd_data(uint8_t data){
 	lcd_execute(data);
 }
 
+/*
+ * Protothread version of lcd_cmd(). The command is sent immediately and the
+ * thread yields until the LCD controller is no longer busy.
+ * Inputs:
+ * 		*pt - protothread state
+ * 		uint8_t command - command to send to lcd controller
+ * Outputs:
+ * 		protothread state
+ */
+PT_THREAD(lcd_cmd_pt(PT *pt, uint8_t command)){
+	PT_BEGIN(pt);
+	*(GPIOB_ODR) &= ~(0b11);	//clear the rw and rs bits
+	PT_SPAWN(pt, &lcd_child, lcd_execute_pt(&lcd_child, command));
+	PT_END(pt);
+}
+
+/*
+ * Protothread version of lcd_data(). The data is sent immediately and the
+ * thread yields until the LCD controller is no longer busy.
+ * Inputs:
+ * 		*pt - protothread state
+ * 		uint8_t data - data to send to lcd controller
+ * Outputs:
+ * 		protothread state
+ */
+PT_THREAD(lcd_data_pt(PT *pt, uint8_t data)){
+	PT_BEGIN(pt);
+	*(GPIOB_ODR) &= ~(0b11);			//clear the rw and rs bits
+	*(GPIOB_ODR) |= (1<<LCD_RS_F);	//set rs high
+	PT_SPAWN(pt, &lcd_child, lcd_execute_pt(&lcd_child, data));
+	PT_END(pt);
+}
+
+/*
+ * Protothread version of lcd_print_string(). Each character is sent as soon
+ * as the controller is ready for it, yielding in between. The string must stay
+ * valid until the thread ends.
+ * Inputs:
+ * 		*pt - protothread state
+ * 		*pointer - pointer to the character array to be printed
+ * Outputs:
+ * 		protothread state
+ */
+PT_THREAD(lcd_print_string_pt(PT *pt, const char *pointer)){
+	static PT data_pt;
+	PT_BEGIN(pt);
+	for(lcd_next = pointer; *lcd_next != '\0'; lcd_next++){
+		PT_SPAWN(pt, &data_pt, lcd_data_pt(&data_pt, *lcd_next));
+	}
+	PT_END(pt);
+}
+
 void static lcd_execute(uint8_t command){
+	send(command);
+	poll_busy();
+}
+
+static PT_THREAD(lcd_execute_pt(PT *pt, uint8_t command)){
+	PT_BEGIN(pt);
+	send(command);
+	set_busy_read_mode();
+	PROF_BEGIN(PROF_LCD_WAIT);
+	lcd_wait_start = DWT_CYCLES();
+	PT_WAIT_UNTIL(pt, (DWT_CYCLES() - lcd_wait_start) >= LCD_BUSY_DELAY_CYCLES);
+	PT_WAIT_UNTIL(pt, read_busy() == 0);
+	PROF_END(PROF_LCD_WAIT);
+	PT_END(pt);
+}
+
+static void send(uint8_t command){
 	//ensure data pins are set to output mode
 	for(int i =8;i<=11;i++){
 		set_pin_mode('C',i,OUTPUT);
@@ -232,7 +310,6 @@ void static lcd_execute(uint8_t command){
 	latch();
 	set_lower_nibble(command);
 	latch();
-	poll_busy();
 }
 
 static void set_upper_nibble(uint8_t command){
@@ -257,28 +334,35 @@ static void latch(){
 }
 
 static void poll_busy(){
+	set_busy_read_mode();
+	
+	//delay 80 us
+	delay_us(LCD_BUSY_DELAY_US);
+	
+	//loop until busy flag is 0
+	while(read_busy()!=0){}
+}
+
+static void set_busy_read_mode(){
 	//set RS low and R/W high
 	*(GPIOB_ODR) &= ~(0b11);
 	*(GPIOB_ODR) |= (1<<LCD_RW_F);
 	
 	//set pin 11 on port C to input mode
 	set_pin_mode('C',11,INPUT);
-	
-	//delay 80 us
-	delay_us(85);
-	
-	//loop until busy flag is 0
+}
+
+static uint8_t read_busy(){
 	uint8_t bf = 1;
-	while(bf!=0){
-		*(GPIOB_ODR) |= (1<<LCD_E_F);	//bring E high(pin 2)
-		delay_us(1);					//delay 1 microsecond to latch
-		if((*(GPIOC_IDR) &= (1<<11))!=(1<<11)){//check bf
-			bf = 0;
-		}
-		*(GPIOB_ODR) &= ~(1<<LCD_E_F);	//bring E low
-		delay_us(1);					//let E settle
-		latch();		//latch
+	*(GPIOB_ODR) |= (1<<LCD_E_F);	//bring E high(pin 2)
+	delay_us(1);					//delay 1 microsecond to latch
+	if((*(GPIOC_IDR) & (1<<11))!=(1<<11)){//check bf
+		bf = 0;
 	}
+	*(GPIOB_ODR) &= ~(1<<LCD_E_F);	//bring E low
+	delay_us(1);					//let E settle
+	latch();		//latch the low nibble of the read
+	return bf;
 }
 
 
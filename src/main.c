@@ -4,15 +4,34 @@
  *  Created on: April 29, 2018
  *      Author: Mitchell Larson
  */
-#include <stdio.h>
 #include <stdbool.h>
-#include <stdlib.h>
 
 #include "ADC.h"
 #include "keypad.h"
 #include "lcd.h"
 #include "timer.h"
 #include "gpio.h"
+#include "pwm.h"
+#include "tach.h"
+#include "control.h"
+#include "history.h"
+#include "alarm.h"
+#include "stats.h"
+#include "event.h"
+#include "task.h"
+#include "uart_driver.h"
+#include "telemetry.h"
+#include "shell.h"
+#include "fmt.h"
+#include "fault.h"
+#include "kv_store.h"
+#include "evlog.h"
+#include "watchdog.h"
+#include "prof.h"
+#include "trace.h"
+
+#define CONSOLE_BAUD	115200
+#define FAN_SETPOINT_RISE	2	//degrees above power-on temperature the fan regulates to
 
 const char *help				= " D-hlp";
 const char *current_temp_msg 	= "Temp: ";
@@ -20,84 +39,125 @@ const char *power_on_temp_msg 	= "On Temp: ";
 const char *offset_up_msg 		= "Offset Up: A";
 const char *offset_down_msg 	= "Offset Down: B";
 
-typedef enum {INIT, READ, RETRIEVE, DISPLAY} State;
-typedef enum {CURRENT, HELP} Mode1;
+typedef enum {CURRENT, HELP, STATS} Mode1;
+
+//alarm policy, the rule table and rate trip can be changed from the shell
+static Rule rules[NUM_LOADS] = ALARM_DEFAULT_RULES;
+static RateTrip rate_trip = ALARM_DEFAULT_RATE_TRIP;
+static AlarmCore alarm;
+
+//running statistics for today and the previous day
+static Stats day_stats[2];
+#define TODAY		0
+#define YESTERDAY	1
+
+//handler rates in milliseconds
+#define SAMPLE_PERIOD	100
+#define KEYPAD_PERIOD	20
+#define DISPLAY_PERIOD	250
+#define HELP_TIME		2000
+#define PERSIST_PERIOD	5000	//settings changes are batched into one flash write this often
+
+//application state shared by the event handlers
+static Mode1 mode = CURRENT;
+static uint32_t help_until;
+static int32_t power_on_milliF;
+static int32_t current_milliF;
+static int32_t sensor_milliF;
+static int offset = 0;
+static char last_key = 0;
+
+//LCD contents written by the display protothread
+#define LCD_COLS 16
+static char lcd_line0[LCD_COLS+1];
+static char lcd_line1[LCD_COLS+1];
+static int8_t display_task;
 
 static void initalize();
-static void read_input(Mode1 *mode, int *offset);
-static void print_current_temp(float current_temp, float power_on_temp, int offset);
+static void on_sample();
+static void on_alarm();
+static void on_keypad();
+static void on_display();
+static void on_tasks();
+static void on_console();
+static void on_persist();
+static void load_settings();
+static void log_reset();
+static void report_fault();
+static void save_settings();
+static void save_setting(uint16_t key, int32_t value);
+static void post_console();
+static void post_persist();
+static PT_THREAD(display_thread(PT *pt));
+static void read_input(char key);
+static void print_current_temp(int32_t current_milliF, int32_t power_on_milliF, int offset);
 static void print_help();
+static void print_stats();
+static void on_second();
+static void refresh_lcd();
 
 /**
  * The main method of the file contains the control flow structure for a program
  * that monitors the current temperature of the external world. On startup initial
- * temperature is recorded, and if the room temperature ever exceeds +5 degrees,
- * the output pins are set to logic-1, triggering external alarms connected to them.
- * The alarm stops when temperature reaches original turn-on temperature.
+ * temperature is recorded, and every sample is run through the alarm core, which
+ * holds the decision logic apart from the hardware. Each load connected to the
+ * output pins has its own trip and release point above the power-on temperature.
+ * The siren is switched fully on, the LED brightness scales with temperature,
+ * and while its rule is active the fan is regulated by a PID loop running in
+ * the background on the filtered temperature.
+ *
+ * Sampling, alarm evaluation, keypad input and display refresh are independent
+ * event handlers running at their own rates, with alarm evaluation dispatched
+ * ahead of everything else.
  * Inputs:
  * 		none
  * Outputs:
  * 		none
  */
 int main(void){
-	//State variables
- 	State state = INIT;
-	Mode1 mode = CURRENT;
-
-	//temperature data
-	float current_temp;
-	float power_on_temp;
-	bool alarmActive = false;
-	int offset = 0;
-
-	while(1){
-		//state machine
-		switch(state){
-			case INIT:
-				initalize();
-				power_on_temp = get_tempF();
-				state = READ;
-				break;
-			case READ:
-				read_input(&mode, &offset);	//pass pointers so copies
-				state = RETRIEVE;				//are not passed
-				break;
-			case RETRIEVE:
-				//retrieve temp and input voltage adjusting extremes if needed
-				current_temp = get_tempF() + offset;
-				if(current_temp >= power_on_temp +5 && alarmActive == false){
-					//set MOSFET gate pins to 1
-					*(GPIOA_ODR)  |= (0x380);
-					alarmActive = true;
-				}else if(alarmActive && current_temp <= power_on_temp){
-					//Turn MOSFETs off
-					*(GPIOA_ODR)  &= ~(0x380);
-					alarmActive = false;
-				}
-				state = DISPLAY;
-				break;
-			case DISPLAY:
-				switch(mode){
-					case CURRENT:
-						print_current_temp(current_temp, power_on_temp, offset);
-						break;
-					case HELP:
-						print_help();
-						delay_ms(2000);
-						mode = CURRENT;
-				}
-
-				state = READ;
-				delay_ms(250);	//wait 250 seconds until the sequence repeats
-				break;
-		}
-	}
+	fault_init();
+	watchdog_init();
+	initalize();
+	power_on_milliF = adc_to_milliF(take_sample());
+	load_settings();
+	log_reset();
+	report_fault();
+	history_init();
+	control_init(power_on_milliF + FAN_SETPOINT_RISE * 1000);
+	alarm_init(&alarm, rules, &rate_trip, power_on_milliF, get_time_ms());
+
+	event_init();
+	PROF_INIT();
+	event_register(EVT_ALARM, on_alarm);
+	event_register(EVT_SAMPLE, on_sample);
+	event_register(EVT_KEYPAD, on_keypad);
+	event_register(EVT_DISPLAY, on_display);
+	event_register(EVT_TASKS, on_tasks);
+	event_register(EVT_CONSOLE, on_console);
+	event_register(EVT_TELEMETRY, telemetry_send);
+	event_register(EVT_PERSIST, on_persist);
+	usart2_set_line_callback(post_console);
+	evlog_set_flush_callback(post_persist);
+	usart2_set_echo(1);
+	stats_init(&day_stats[TODAY], get_time_ms());
+	stats_init(&day_stats[YESTERDAY], get_time_ms());
+	shell_init(rules, alarm.states, NUM_LOADS, &rate_trip, &alarm.rate, day_stats);
+	display_task = task_add(display_thread);
+	event_every(EVT_SAMPLE, SAMPLE_PERIOD);
+	event_every(EVT_KEYPAD, KEYPAD_PERIOD);
+	event_every(EVT_DISPLAY, DISPLAY_PERIOD);
+	event_every(EVT_TELEMETRY, TELEMETRY_PERIOD);
+	event_every(EVT_PERSIST, PERSIST_PERIOD);
+	telemetry_enable(TELEMETRY_AT_BOOT);
+
+	event_run();
 	return 0;
 }
 
 /**
  * This function will initialize the Analog to digital converter, the keypad,
- * the LCD, and the output pins driving the MOSFET gate terminals.
+ * the LCD, the console UART, the PWM outputs driving the MOSFET gate terminals
+ * and the fan tachometer.
  * Inputs:
  * 		none
  * Outputs:
@@ -107,35 +167,413 @@ static void initalize(){
 	ADC_init();
 	key_init();
 	lcd_init(C_OFF);
+	tick_init();
+
+	//console output is queued for DMA
+	init_usart2(CONSOLE_BAUD, clock_get_pclk1());
+
+	//drive MOSFET gates from timer channels, all loads start off
+	pwm_init(PWM_DEFAULT_FREQ);
+	tach_init();
+}
+
+/**
+ * Sample event handler. Collects the filtered temperature, adjusted by the user
+ * offset, from the control loop and requests an alarm evaluation.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+static void on_sample(){
+	WATCHDOG_CHECKIN(WATCHDOG_SAMPLE);
+	control_set_offset(offset * 1000);
+	alarm_set_offset(&alarm, offset * 1000);
+	current_milliF = control_get_milliF();
+	sensor_milliF = current_milliF - offset * 1000;
+	trace(TRACE_TEMP, current_milliF / 100);
+	event_post(EVT_ALARM);
+}
+
+/**
+ * This function runs once a second, after the alarm core has taken its rate
+ * sample. The statistics count time above each load's trip point and start a
+ * new day every STATS_DAY_MS, keeping the previous day.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+static void on_second(){
+	PROF_BEGIN(PROF_STATS);
+	uint32_t now = get_time_ms();
+	Stats *today = &day_stats[TODAY];
+	if(now - today->start_ms >= STATS_DAY_MS){
+		day_stats[YESTERDAY] = *today;
+		stats_init(today, now);
+	}
+	for(int i = 0; i < NUM_LOADS && i < STATS_THRESHOLDS; i++){
+		stats_set_threshold(today, i, power_on_milliF + rules[i].on_milliF);
+	}
+	stats_update(today, current_milliF, now);
+	PROF_END(PROF_STATS);
+}
+
+/**
+ * Alarm event handler. Runs the alarm core on the latest sample and drives the
+ * MOSFET gates with its commands, checks the fan is turning when it is driven,
+ * then logs each load and the rate trip switching.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+static void on_alarm(){
+	AlarmOutput out;
+	PROF_BEGIN(PROF_RULES);
+	alarm_step(&alarm, sensor_milliF, get_time_ms(), &out);
+	PROF_END(PROF_RULES);
+	pwm_set_duty(LOAD_LED, out.led_duty);
+	pwm_set_duty(LOAD_SIREN, out.siren_duty);
+	control_enable_fan(out.fan_enable);
+	if(tach_check_stall(pwm_get_duty(LOAD_FAN), get_time_ms())){
+		trace(TRACE_STALL, tach_stalled());
+		if(tach_stalled()){
+			evlog_post(EVLOG_FAULT, EVLOG_FAULT_FAN_STALL, tach_get_rpm());
+		}
+	}
+
+	if(out.rate_updated){
+		on_second();
+	}
+	if(out.rate_changed){
+		trace(TRACE_RATE, rate_trip.active);
+		evlog_post(rate_trip.active ? EVLOG_RATE_ON : EVLOG_RATE_OFF, rate_trip.loads, alarm.rate_milliF);
+	}
+
+	uint32_t changed = out.changed;
+	if(changed){
+		trace(TRACE_LOADS, out.loads);
+	}
+	for(int load = 0; changed != 0; load++, changed >>= 1){
+		if(changed & 1){
+			evlog_post((out.loads & (1<<load)) ? EVLOG_ALARM_ON : EVLOG_ALARM_OFF, load, out.milliF);
+		}
+	}
+}
+
+/**
+ * Keypad event handler. Scans the keypad and acts once per key press, when a
+ * new key is first seen.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+static void on_keypad(){
+	WATCHDOG_CHECKIN(WATCHDOG_INPUT);
+	char key = key_getchar_noblock();
+	if(key != last_key && key != 0){
+		read_input(key);
+	}
+	last_key = key;
+}
+
+/**
+ * Display event handler. Shows the current temperature page, the statistics
+ * page, or the help page until it times out. A refresh is skipped if the
+ * previous one is still being written to the LCD, and the watchdog only hears
+ * from the display once it has finished.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+static void on_display(){
+	if(task_active(display_task)){
+		return;
+	}
+	WATCHDOG_CHECKIN(WATCHDOG_DISPLAY);
+
+	PROF_BEGIN(PROF_FORMAT);
+	switch(mode){
+		case CURRENT:
+			print_current_temp(current_milliF, power_on_milliF, offset);
+			break;
+		case HELP:
+			if((int32_t)(get_time_ms() - help_until) >= 0){
+				mode = CURRENT;
+				print_current_temp(current_milliF, power_on_milliF, offset);
+			}else{
+				print_help();
+			}
+			break;
+		case STATS:
+			print_stats();
+			break;
+	}
+	PROF_END(PROF_FORMAT);
+}
+
+/**
+ * Console event handler. Runs every complete line typed at the console as a
+ * shell command.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+static void on_console(){
+	char line[USART2_LINE_SIZE];
+	while(usart2_readline(line, sizeof(line)) >= 0){
+		shell_execute(line);
+	}
+}
+
+/**
+ * Persist event handler. Copies the settings into the store, writes any that
+ * changed since the last pass to flash, and then writes the buffered event log.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+static void on_persist(){
+	PROF_BEGIN(PROF_PERSIST);
+	save_settings();
+	if(kv_commit() < 0){
+		evlog_post(EVLOG_FAULT, EVLOG_FAULT_FLASH, 0);
+	}
+	evlog_flush();
+	PROF_END(PROF_PERSIST);
+}
+
+/**
+ * This function loads the settings store and restores the power-on temperature,
+ * offset, rule table and rate trip saved by an earlier run. Settings that were
+ * never saved keep their defaults, and the power-on temperature just measured
+ * is saved the first time, so later resets keep the same baseline.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+static void load_settings(){
+	int32_t value;
+	if(kv_init() < 0){
+		return;
+	}
+
+	if(kv_get(KV_KEY_POWER_ON, &value)){
+		power_on_milliF = value;
+	}else{
+		kv_set(KV_KEY_POWER_ON, power_on_milliF);
+	}
+	if(kv_get(KV_KEY_OFFSET, &value)){
+		offset = value;
+	}
+	if(kv_get(KV_KEY_RATE_ON, &value)){
+		rate_trip.on_rate = value;
+	}
+	if(kv_get(KV_KEY_RATE_OFF, &value)){
+		rate_trip.off_rate = value;
+	}
+	if(kv_get(KV_KEY_RATE_LOADS, &value)){
+		rate_trip.loads = value;
+	}
+	for(int i = 0; i < NUM_LOADS; i++){
+		int32_t *fields[4] = {&rules[i].on_milliF, &rules[i].off_milliF,
+				(int32_t*)&rules[i].min_on_ms, (int32_t*)&rules[i].min_off_ms};
+		for(int field = 0; field < 4; field++){
+			if(kv_get(KV_KEY_RULE(rules[i].load, field), &value)){
+				*fields[field] = value;
+			}
+		}
+	}
+
+	value = 0;
+	kv_get(KV_KEY_BOOTS, &value);
+	kv_set(KV_KEY_BOOTS, value + 1);
+}
+
+/**
+ * This function copies the offset, rule table and rate trip into the settings
+ * store. Only values that changed are written by the next commit.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+static void save_settings(){
+	save_setting(KV_KEY_OFFSET, offset);
+	save_setting(KV_KEY_RATE_ON, rate_trip.on_rate);
+	save_setting(KV_KEY_RATE_OFF, rate_trip.off_rate);
+	save_setting(KV_KEY_RATE_LOADS, rate_trip.loads);
+	for(int i = 0; i < NUM_LOADS; i++){
+		save_setting(KV_KEY_RULE(rules[i].load, 0), rules[i].on_milliF);
+		save_setting(KV_KEY_RULE(rules[i].load, 1), rules[i].off_milliF);
+		save_setting(KV_KEY_RULE(rules[i].load, 2), rules[i].min_on_ms);
+		save_setting(KV_KEY_RULE(rules[i].load, 3), rules[i].min_off_ms);
+	}
+}
+
+/**
+ * This helper function stores one setting, logging it if it changed.
+ * Inputs:
+ * 		key - settings store key
+ * 		value - current value
+ * Outputs:
+ * 		none
+ */
+static void save_setting(uint16_t key, int32_t value){
+	int32_t saved;
+	if(!kv_get(key, &saved) || saved != value){
+		kv_set(key, value);
+		evlog_post(EVLOG_CONFIG, key, value);
+	}
+}
 
-	//set gpio pins for controlling MOSFETs to output mode
-	for(int i = 7; i <= 9; i++){
-		set_pin_mode('A',i,OUTPUT);
+/**
+ * This function reports a crash that caused the last reset, once: the crash
+ * record is printed to the console, logged and counted in the settings store.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+static void report_fault(){
+	const FaultRecord *fault = fault_get();
+	if(fault == 0 || fault->reported){
+		return;
 	}
+	fault_print(fault);
+	evlog_post(EVLOG_FAULT, EVLOG_FAULT_CRASH | fault->type, fault->pc);
 
-	//initialize pins to 0
-	*(GPIOA_ODR)  &= ~(0x380);
+	int32_t faults = 0;
+	kv_get(KV_KEY_FAULTS, &faults);
+	kv_set(KV_KEY_FAULTS, faults + 1);
+	fault_mark_reported();
 }
 
 /**
- * This function will read any input from the key pad, if any, and change one of
- *  the state variable based on the user input.
+ * This function recovers the event log and records the reset, with the boot
+ * count and the cause reported by the reset flags, which are then cleared. A
+ * watchdog reset is also logged as a fault naming the task that was late.
  * Inputs:
- * 		*mode - pointer to the state variable mode
- * 		*offset - pointer to the temperature offset
+ * 		none
+ * Outputs:
+ * 		none
+ */
+static void log_reset(){
+	int32_t boots = 0;
+	kv_get(KV_KEY_BOOTS, &boots);
+	evlog_init();
+	evlog_post(EVLOG_RESET, *(RCC_CSR) >> RCC_CSR_FLAGS_F, boots);
+	if(*(RCC_CSR) & (1<<RCC_CSR_IWDGRSTF_F)){
+		evlog_post(EVLOG_FAULT, EVLOG_FAULT_WATCHDOG, watchdog_late());
+	}
+	*(RCC_CSR) |= (1<<RCC_CSR_RMVF_F);
+}
+
+/**
+ * Console line callback, runs in the USART2 interrupt and defers the line to
+ * the console event handler.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+static void post_console(){
+	trace(TRACE_CONSOLE, 0);
+	event_post(EVT_CONSOLE);
+}
+
+/**
+ * Event log flush callback, brings the next persist pass forward when the log's
+ * RAM buffer is filling up.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+static void post_persist(){
+	event_post(EVT_PERSIST);
+}
+
+/**
+ * Task event handler. Resumes every waiting protothread once and keeps itself
+ * posted, at the lowest priority, until they have all finished.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+static void on_tasks(){
+	if(task_poll() != 0){
+		event_post(EVT_TASKS);
+	}
+}
+
+/**
+ * Protothread that writes the two LCD lines. The LCD is cleared and each line
+ * is written a character at a time, yielding whenever the LCD is busy so the
+ * control handlers keep running while the display updates.
+ * Inputs:
+ * 		*pt - protothread state
+ * Outputs:
+ * 		protothread state
+ */
+static PT_THREAD(display_thread(PT *pt)){
+	static PT child;
+	PT_BEGIN(pt);
+	PT_SPAWN(pt, &child, lcd_cmd_pt(&child, LCD_CLEAR_CMD));
+	PT_SPAWN(pt, &child, lcd_cmd_pt(&child, LCD_HOME_CMD));
+	PT_SPAWN(pt, &child, lcd_print_string_pt(&child, lcd_line0));
+	PT_SPAWN(pt, &child, lcd_cmd_pt(&child, LCD_ROW1_CMD));
+	PT_SPAWN(pt, &child, lcd_print_string_pt(&child, lcd_line1));
+	PT_END(pt);
+}
+
+/**
+ * This helper function starts the display protothread writing the LCD lines.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+static void refresh_lcd(){
+	task_start(display_task);
+	event_post(EVT_TASKS);
+}
+
+/**
+ * This function acts on a key read from the key pad, changing the offset,
+ * switching between the temperature and statistics pages, or showing the help
+ * page.
+ * Inputs:
+ * 		key - ascii character of the key pressed
  * Outputs:
  * 		none, but the state variables may change upon running this function
  */
-static void read_input(Mode1 *mode, int *offset){
-	switch(key_getchar_noblock()){
+static void read_input(char key){
+	trace(TRACE_KEY, key);
+	switch(key){
 		case 'A':
-			*offset = *offset+1;
+			offset = offset+1;
+			event_post(EVT_SAMPLE);
 			break;
 		case 'B':
-			*offset = *offset -1;
+			offset = offset -1;
+			event_post(EVT_SAMPLE);
+			break;
+		case 'C':
+			mode = (mode == STATS) ? CURRENT : STATS;
+			event_post(EVT_DISPLAY);
 			break;
 		case 'D':
-			*mode = HELP;
+			mode = HELP;
+			help_until = get_time_ms() + HELP_TIME;
+			event_post(EVT_DISPLAY);
 			break;
 		default:
 			break;
@@ -147,30 +585,22 @@ static void read_input(Mode1 *mode, int *offset){
  * the power-on temperature. The temperature offset and help option are displayed
  * as well to provide additional information to the user.
  * Inputs:
- * 		current_temp - temperature to display
- * 		tempMode - the temperature mode the program is in
+ * 		current_milliF - temperature to display, thousandths of a degree
+ * 		power_on_milliF - power-on temperature, thousandths of a degree
+ * 		offset - user offset in degrees
  * Outputs:
  * 		none
  */
-static void print_current_temp(float current_temp, float power_on_temp, int offset){
-	lcd_reset();
-	char buffer1[5];
-	sprintf(buffer1,"%4.1f",current_temp);
-	
-	char buffer2[5];
-	sprintf(buffer2,"%4.1f", power_on_temp);
-
-	char buffer3[3];
-	itoa(offset, buffer3, 10);
+static void print_current_temp(int32_t current_milliF, int32_t power_on_milliF, int offset){
+	uint32_t pos = fmt_str(lcd_line0, sizeof(lcd_line0), 0, current_temp_msg);
+	pos = fmt_milli(lcd_line0, sizeof(lcd_line0), pos, current_milliF, 1, 4);
+	fmt_str(lcd_line0, sizeof(lcd_line0), pos, help);
 
-	lcd_print_string(current_temp_msg);
-	lcd_print_string(buffer1);
-	lcd_print_string(help);
-	lcd_row1();
-	lcd_print_string(power_on_temp_msg);
-	lcd_print_string(buffer2);
-	lcd_print_string(" ");
-	lcd_print_string(buffer3);
+	pos = fmt_str(lcd_line1, sizeof(lcd_line1), 0, power_on_temp_msg);
+	pos = fmt_milli(lcd_line1, sizeof(lcd_line1), pos, power_on_milliF, 1, 4);
+	pos = fmt_str(lcd_line1, sizeof(lcd_line1), pos, " ");
+	fmt_int(lcd_line1, sizeof(lcd_line1), pos, offset, 0);
+	refresh_lcd();
 }
 
 /**
@@ -181,9 +611,34 @@ static void print_current_temp(float current_temp, float power_on_temp, int offs
  * 		noen
  */
 static void print_help(){
-	lcd_reset();
-	lcd_print_string(offset_up_msg);
-	lcd_row1();
-	lcd_print_string(offset_down_msg);
+	fmt_str(lcd_line0, sizeof(lcd_line0), 0, offset_up_msg);
+	fmt_str(lcd_line1, sizeof(lcd_line1), 0, offset_down_msg);
+	refresh_lcd();
+}
 
+/**
+ * This helper function prints today's statistics to the LCD: the low and high
+ * on the first line, the mean and standard deviation on the second.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+static void print_stats(){
+	const Stats *today = &day_stats[TODAY];
+	if(today->count == 0){
+		fmt_str(lcd_line0, sizeof(lcd_line0), 0, "No stats yet");
+		lcd_line1[0] = '\0';
+	}else{
+		uint32_t pos = fmt_str(lcd_line0, sizeof(lcd_line0), 0, "Lo");
+		pos = fmt_milli(lcd_line0, sizeof(lcd_line0), pos, today->min, 1, 5);
+		pos = fmt_str(lcd_line0, sizeof(lcd_line0), pos, " Hi");
+		fmt_milli(lcd_line0, sizeof(lcd_line0), pos, today->max, 1, 5);
+
+		pos = fmt_str(lcd_line1, sizeof(lcd_line1), 0, "Av");
+		pos = fmt_milli(lcd_line1, sizeof(lcd_line1), pos, stats_mean(today), 1, 5);
+		pos = fmt_str(lcd_line1, sizeof(lcd_line1), pos, " Sd");
+		fmt_milli(lcd_line1, sizeof(lcd_line1), pos, stats_stddev(today), 2, 4);
+	}
+	refresh_lcd();
 }
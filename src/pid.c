@@ -0,0 +1,101 @@
+/*
+ * pid.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements a fixed-point PID controller. The controller is reverse
+ * acting(a measurement above the setpoint drives the output up), which is what a
+ * cooling fan needs. No floating point or division is used, so an update is cheap
+ * enough to run from a timer interrupt.
+ */
+
+#include "pid.h"
+
+static int32_t clamp(int64_t value, int32_t min, int32_t max);
+
+/*
+ * This function initializes a PID controller with the gains and limits given
+ * and clears its state.
+ * Inputs:
+ * 		*pid - controller to initialize
+ * 		kp, ki, kd - Q16.16 gains, see PID_GAIN()
+ * 		out_min, out_max - output limits, also used to limit the integrator
+ * 		d_shift - derivative filter strength, 0 disables filtering
+ * Outputs:
+ * 		none
+ */
+void pid_init(PID *pid, int32_t kp, int32_t ki, int32_t kd, int32_t out_min, int32_t out_max, uint8_t d_shift){
+	pid->kp = kp;
+	pid->ki = ki;
+	pid->kd = kd;
+	pid->out_min = out_min;
+	pid->out_max = out_max;
+	pid->d_shift = d_shift;
+	pid_reset(pid);
+}
+
+/*
+ * This function clears the integrator and derivative history of a controller.
+ * Inputs:
+ * 		*pid - controller to reset
+ * Outputs:
+ * 		none
+ */
+void pid_reset(PID *pid){
+	pid->integral = 0;
+	pid->derivative = 0;
+	pid->prev_meas = 0;
+	pid->primed = 0;
+}
+
+/*
+ * This function runs one update of the controller. The derivative acts on the
+ * measurement rather than the error so setpoint changes do not kick the output.
+ * The integrator only accumulates while the output is not saturated in the
+ * direction of the error, and is clamped to the output range, so it cannot wind
+ * up while the fan is pinned at full speed or off.
+ * Inputs:
+ * 		*pid - controller to update
+ * 		setpoint - target measurement
+ * 		measurement - current measurement
+ * Outputs:
+ * 		controller output, between out_min and out_max
+ */
+int32_t pid_update(PID *pid, int32_t setpoint, int32_t measurement){
+	int32_t error = measurement - setpoint;
+	int32_t min = pid->out_min << PID_Q;
+	int32_t max = pid->out_max << PID_Q;
+
+	if(!pid->primed){
+		pid->prev_meas = measurement;
+		pid->primed = 1;
+	}
+
+	//proportional term
+	int32_t p = clamp(((int64_t)pid->kp * error), min - max, max - min);
+
+	//filtered derivative on measurement
+	int32_t d_raw = clamp(((int64_t)pid->kd * (measurement - pid->prev_meas)), min - max, max - min);
+	pid->derivative += (d_raw - pid->derivative) >> pid->d_shift;
+	pid->prev_meas = measurement;
+
+	//conditional integration
+	int32_t i_step = clamp(((int64_t)pid->ki * error), min - max, max - min);
+	int32_t out = p + pid->integral + pid->derivative;
+	if(!((out >= max && i_step > 0) || (out <= min && i_step < 0))){
+		pid->integral = clamp(pid->integral + i_step, min, max);
+	}
+
+	out = clamp(p + pid->integral + pid->derivative, min, max);
+	return out >> PID_Q;
+}
+
+static int32_t clamp(int64_t value, int32_t min, int32_t max){
+	if(value < min){
+		return min;
+	}else if(value > max){
+		return max;
+	}
+	return value;
+}
@@ -0,0 +1,100 @@
+/*
+ * prof.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements the zone profiler. Each zone keeps a count, the
+ * shortest, longest and total cycles, and a histogram with one bin per power
+ * of two, in a static table. Recording a zone costs a count leading zeros and a
+ * few loads and stores with interrupts held off. Nothing here is built unless
+ * PROFILE is defined.
+ */
+
+#ifdef PROFILE
+
+#include "prof.h"
+#include "nvic.h"
+
+uint32_t prof_start[NUM_PROF_ZONES];
+static ProfStats zones[NUM_PROF_ZONES];
+
+/*
+ * This function adds one run of a zone to its statistics. It is called by
+ * PROF_END and is safe from any context.
+ * Inputs:
+ * 		zone - zone that ended
+ * 		cycles - cycles since the zone began
+ * Outputs:
+ * 		none
+ */
+void prof_record(ProfZone zone, uint32_t cycles){
+	int bin = (31 - __builtin_clz(cycles | 1)) - PROF_BIN_SHIFT;
+	if(bin < 0){
+		bin = 0;
+	}else if(bin >= PROF_BINS){
+		bin = PROF_BINS - 1;
+	}
+
+	uint32_t primask = irq_save();
+	ProfStats *stats = &zones[zone];
+	stats->count++;
+	stats->total_cycles += cycles;
+	if(cycles < stats->min_cycles){
+		stats->min_cycles = cycles;
+	}
+	if(cycles > stats->max_cycles){
+		stats->max_cycles = cycles;
+	}
+	stats->hist[bin]++;
+	irq_restore(primask);
+}
+
+/*
+ * This function copies the statistics of one zone.
+ * Inputs:
+ * 		zone - zone to read
+ * 		*stats - where to copy the statistics
+ * Outputs:
+ * 		none
+ */
+void prof_get(ProfZone zone, ProfStats *stats){
+	uint32_t primask = irq_save();
+	*stats = zones[zone];
+	irq_restore(primask);
+}
+
+/*
+ * This function clears the statistics of every zone.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void prof_clear(){
+	uint32_t primask = irq_save();
+	for(int i = 0; i < NUM_PROF_ZONES; i++){
+		zones[i].count = 0;
+		zones[i].min_cycles = UINT32_MAX;
+		zones[i].max_cycles = 0;
+		zones[i].total_cycles = 0;
+		for(int bin = 0; bin < PROF_BINS; bin++){
+			zones[i].hist[bin] = 0;
+		}
+	}
+	irq_restore(primask);
+}
+
+/*
+ * This function returns the fewest cycles counted in a histogram bin. Bin 0
+ * also counts everything shorter.
+ * Inputs:
+ * 		bin - histogram bin
+ * Outputs:
+ * 		lower bound of the bin in cycles
+ */
+uint32_t prof_bin_low(uint8_t bin){
+	return bin == 0 ? 0 : (uint32_t)1 << (bin + PROF_BIN_SHIFT);
+}
+
+#endif /* PROFILE */
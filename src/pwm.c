@@ -0,0 +1,176 @@
+/*
+ * pwm.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements hardware PWM drive of the MOSFET gates. The fan(PA8) and
+ * siren(PA9) are driven from TIM1 channels 1 and 2, and the LED(PA7) is driven
+ * from TIM3 channel 2. Once configured the timers generate the waveforms on their
+ * own, so changing a duty cycle is a single compare register write.
+ */
+
+#include "pwm.h"
+
+static uint16_t duties[NUM_LOADS];
+static uint32_t period;
+
+static void set_compare(Load load, uint32_t compare);
+
+/*
+ * This function initializes PWM output on the three MOSFET gate pins. The pins
+ * are switched to their timer alternate functions, both timers are configured for
+ * PWM mode 1 on the gate channels and all loads start with a duty cycle of 0.
+ * Inputs:
+ * 		freq_hz - PWM frequency in Hz
+ * Outputs:
+ * 		none
+ */
+void pwm_init(uint32_t freq_hz){
+	//enable clocks for GPIOA, TIM1 and TIM3
+	enable_clock('A');
+	*(RCC_APB2ENR) |= (1<<TIM1_RCCEN_F);
+	*(RCC_APB1ENR) |= (1<<TIM3_RCCEN_F);
+
+	//route gate pins to their timer channels
+	set_alt_func('A', LOAD_LED_PIN, 2);		//TIM3_CH2
+	set_alt_func('A', LOAD_FAN_PIN, 1);		//TIM1_CH1
+	set_alt_func('A', LOAD_SIREN_PIN, 1);	//TIM1_CH2
+	for(int i = LOAD_LED_PIN; i <= LOAD_SIREN_PIN; i++){
+		set_pin_mode('A', i, ALTFUNC);
+	}
+
+	//PWM mode 1 with preloaded compare registers
+	*(TIM1_CCMR1) = (TIM_OCM_PWM1<<TIM_CCMR1_OC1M_F) | (1<<TIM_CCMR1_OC1PE_F)
+			| (TIM_OCM_PWM1<<TIM_CCMR1_OC2M_F) | (1<<TIM_CCMR1_OC2PE_F);
+	*(TIM3_CCMR1) = (TIM_OCM_PWM1<<TIM_CCMR1_OC2M_F) | (1<<TIM_CCMR1_OC2PE_F);
+
+	//enable channel outputs, TIM1 also needs the main output enable
+	*(TIM1_CCER) = (1<<TIM_CCER_CC1E_F) | (1<<TIM_CCER_CC2E_F);
+	*(TIM3_CCER) = (1<<TIM_CCER_CC2E_F);
+	*(TIM1_BDTR) |= (1<<TIM_BDTR_MOE_F);
+
+	for(int i = 0; i < NUM_LOADS; i++){
+		duties[i] = 0;
+	}
+	pwm_set_frequency(freq_hz);
+
+	//start counters with auto reload preload
+	*(TIM1_CR1) = (1<<TIM_CR1_ARPE_F) | (1<<TIM_CR1_CEN_F);
+	*(TIM3_CR1) = (1<<TIM_CR1_ARPE_F) | (1<<TIM_CR1_CEN_F);
+}
+
+/*
+ * This function changes the PWM frequency of all loads. The prescaler is chosen
+ * so that a period has at least PWM_DUTY_MAX counts when possible, giving full
+ * duty cycle resolution. TIM1 is on APB2 and may be clocked faster than TIM3 on
+ * APB1, so its prescaler is scaled up to make both count at the same rate and
+ * share one period. Current duty cycles are preserved.
+ * Inputs:
+ * 		freq_hz - PWM frequency in Hz
+ * Outputs:
+ * 		none
+ */
+void pwm_set_frequency(uint32_t freq_hz){
+	if(freq_hz == 0){
+		return;
+	}
+
+	uint32_t tim3_clk = clock_get_apb1_timer_clk();
+	uint32_t ratio = clock_get_apb2_timer_clk() / tim3_clk;
+	uint32_t psc = tim3_clk / (freq_hz * PWM_DUTY_MAX);
+	if(psc > 0){
+		psc--;
+	}
+	if(ratio*(psc+1) > 0x10000){
+		psc = 0x10000/ratio - 1;
+	}
+	period = tim3_clk / ((psc+1) * freq_hz);
+	if(period > 0xFFFF){
+		period = 0xFFFF;
+	}else if(period < 2){
+		period = 2;
+	}
+
+	*(TIM1_PSC) = ratio*(psc+1) - 1;
+	*(TIM3_PSC) = psc;
+	*(TIM1_ARR) = period - 1;
+	*(TIM3_ARR) = period - 1;
+
+	for(int i = 0; i < NUM_LOADS; i++){
+		pwm_set_duty(i, duties[i]);
+	}
+
+	//load prescaler and period immediately
+	*(TIM1_EGR) = (1<<TIM_EGR_UG_F);
+	*(TIM3_EGR) = (1<<TIM_EGR_UG_F);
+}
+
+/*
+ * This function sets the duty cycle of a single load. A duty of PWM_DUTY_MAX
+ * holds the gate high for the whole period, and 0 holds it low. The new value
+ * takes effect at the start of the next PWM period.
+ * Inputs:
+ * 		load - load to change
+ * 		duty - duty cycle in tenths of a percent(0 - PWM_DUTY_MAX)
+ * Outputs:
+ * 		none
+ */
+void pwm_set_duty(Load load, uint16_t duty){
+	if(load >= NUM_LOADS){
+		return;
+	}
+	if(duty > PWM_DUTY_MAX){
+		duty = PWM_DUTY_MAX;
+	}
+	duties[load] = duty;
+
+	//a compare value of period or more keeps the output high all period
+	set_compare(load, (duty * period) / PWM_DUTY_MAX);
+}
+
+/*
+ * This function returns the last duty cycle set for a load.
+ * Inputs:
+ * 		load - load to query
+ * Outputs:
+ * 		duty cycle in tenths of a percent
+ */
+uint16_t pwm_get_duty(Load load){
+	if(load >= NUM_LOADS){
+		return 0;
+	}
+	return duties[load];
+}
+
+/*
+ * This function drives every gate low as a plain GPIO output, taking the pins
+ * away from the timers. It only writes registers, so it is safe to call from a
+ * fault handler. pwm_init() gives the pins back to the timers.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void pwm_force_off(){
+	*(GPIOA_ODR) &= ~LOAD_ALL_MASK;
+	for(int i = LOAD_LED_PIN; i <= LOAD_SIREN_PIN; i++){
+		*(GPIOA_MODER) = (*(GPIOA_MODER) & ~(3<<(2*i))) | (OUTPUT<<(2*i));
+	}
+}
+
+static void set_compare(Load load, uint32_t compare){
+	switch(load){
+		case LOAD_LED:
+			*(TIM3_CCR2) = compare;
+			break;
+		case LOAD_FAN:
+			*(TIM1_CCR1) = compare;
+			break;
+		case LOAD_SIREN:
+			*(TIM1_CCR2) = compare;
+			break;
+		default:
+			return;
+	}
+}
@@ -0,0 +1,108 @@
+/*
+ * rate.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements the rate of rise estimate used to trip loads on a fast
+ * temperature ramp. The slope of a least squares line through a sliding window
+ * of samples is
+ * 		slope = (n*Sxy - Sx*Sy) / (n*Sxx - Sx*Sx)
+ * With samples numbered 0 to n-1, Sx and Sxx depend only on n, and sliding the
+ * window by one sample renumbers every kept sample one lower, so
+ * 		Sxy' = Sxy - (Sy - oldest) + (n-1)*newest
+ * 		Sy'  = Sy - oldest + newest
+ * Each update and each slope is a fixed number of integer operations.
+ */
+
+#include "rate.h"
+
+/*
+ * This function empties the slope window.
+ * Inputs:
+ * 		*est - estimator
+ * Outputs:
+ * 		none
+ */
+void rate_init(RateEstimator *est){
+	est->head = 0;
+	est->count = 0;
+	est->sum = 0;
+	est->sum_xy = 0;
+}
+
+/*
+ * This function adds a sample to the window, dropping the oldest once the
+ * window is full.
+ * Inputs:
+ * 		*est - estimator
+ * 		milliF - temperature in thousandths of a degree
+ * Outputs:
+ * 		none
+ */
+void rate_update(RateEstimator *est, int32_t milliF){
+	if(est->count < RATE_WINDOW){
+		est->sum_xy += (int64_t)est->count * milliF;
+		est->sum += milliF;
+		est->samples[est->count++] = milliF;
+		return;
+	}
+
+	int32_t oldest = est->samples[est->head];
+	est->sum_xy += -(est->sum - oldest) + (int64_t)(RATE_WINDOW - 1) * milliF;
+	est->sum += milliF - oldest;
+	est->samples[est->head] = milliF;
+	est->head = (est->head + 1) % RATE_WINDOW;
+}
+
+/*
+ * This function reports whether the window is full, so the slope covers the
+ * whole window.
+ * Inputs:
+ * 		*est - estimator
+ * Outputs:
+ * 		1 if the window is full, 0 otherwise
+ */
+uint8_t rate_valid(const RateEstimator *est){
+	return est->count == RATE_WINDOW;
+}
+
+/*
+ * This function returns the least squares slope of the samples in the window.
+ * Inputs:
+ * 		*est - estimator
+ * 		period_ms - milliseconds between samples
+ * Outputs:
+ * 		slope in thousandths of a degree per minute, 0 with fewer than two samples
+ */
+int32_t rate_per_minute(const RateEstimator *est, uint32_t period_ms){
+	int64_t n = est->count;
+	if(n < 2){
+		return 0;
+	}
+	int64_t sum_x = n*(n-1) / 2;
+	int64_t denominator = n*n*(n*n - 1) / 12;		//n*Sxx - Sx*Sx
+	int64_t numerator = n*est->sum_xy - sum_x*est->sum;
+	return (numerator * RATE_MS_PER_MIN) / (denominator * period_ms);
+}
+
+/*
+ * This function evaluates the rate of rise trip, with hysteresis between the
+ * on and off rates. The trip never operates until the window is full.
+ * Inputs:
+ * 		*trip - trip settings and state, updated
+ * 		*est - estimator
+ * 		rate - slope from rate_per_minute()
+ * Outputs:
+ * 		bit mask of loads to energize, bit n corresponds to Load n
+ */
+uint32_t rate_trip_evaluate(RateTrip *trip, const RateEstimator *est, int32_t rate){
+	if(trip->on_rate == 0 || !rate_valid(est)){
+		trip->active = 0;
+	}else if(rate >= trip->on_rate){
+		trip->active = 1;
+	}else if(rate <= trip->off_rate){
+		trip->active = 0;
+	}
+	return trip->active ? trip->loads : 0;
+}
@@ -0,0 +1,70 @@
+/*
+ * rules.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements the evaluator for the load rule table. Every rule is
+ * evaluated with the same straight line sequence of comparisons, so the cost of
+ * a pass is linear in the number of rules and uses no floating point.
+ */
+
+#include "rules.h"
+
+/*
+ * This function clears the state of every rule, leaving all loads off. Each
+ * load starts as if it had already been off for its minimum off time, so a
+ * reset into a hot cabinet energizes it on the first evaluation.
+ * Inputs:
+ * 		*rules - rule table
+ * 		*states - rule state array
+ * 		count - number of rules
+ * 		now_ms - current time in milliseconds
+ * Outputs:
+ * 		none
+ */
+void rules_init(const Rule *rules, RuleState *states, uint8_t count, uint32_t now_ms){
+	for(int i = 0; i < count; i++){
+		states[i].active = 0;
+		states[i].since_ms = now_ms - rules[i].min_off_ms;
+	}
+}
+
+/*
+ * This function evaluates every rule against one temperature sample and returns
+ * which loads should be on. A load only changes state when its threshold is
+ * crossed and it has held its current state for the minimum on or off time.
+ * Inputs:
+ * 		*rules - rule table
+ * 		*states - rule state array, updated
+ * 		count - number of rules
+ * 		rise_milliF - temperature above power-on temperature, thousandths of a degree
+ * 		now_ms - current time in milliseconds
+ * Outputs:
+ * 		bit mask of loads that should be on, bit n corresponds to Load n
+ */
+uint32_t rules_evaluate(const Rule *rules, RuleState *states, uint8_t count, int32_t rise_milliF, uint32_t now_ms){
+	uint32_t mask = 0;
+
+	for(int i = 0; i < count; i++){
+		const Rule *rule = &rules[i];
+		RuleState *state = &states[i];
+		uint32_t active = state->active;
+
+		//elapsed time is compared against the minimum time for the current state
+		uint32_t held = now_ms - state->since_ms;
+		uint32_t min_hold = active ? rule->min_on_ms : rule->min_off_ms;
+		uint32_t may_switch = held >= min_hold;
+
+		uint32_t turn_on = (rise_milliF >= rule->on_milliF) & !active;
+		uint32_t turn_off = (rise_milliF <= rule->off_milliF) & active;
+		uint32_t change = (turn_on | turn_off) & may_switch;
+
+		active ^= change;
+		state->active = active;
+		state->since_ms = change ? now_ms : state->since_ms;
+		mask |= active << rule->load;
+	}
+
+	return mask;
+}
@@ -0,0 +1,772 @@
+/*
+ * shell.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements a small command shell on the console. A line is split
+ * into words in place and the first word is looked up in a static command
+ * table. Nothing is allocated, and all output goes through the DMA transmit
+ * ring, so commands run as ordinary event handlers without holding up sampling
+ * or gate control.
+ */
+
+#include <string.h>
+#include "shell.h"
+#include "uart_driver.h"
+#include "control.h"
+#include "tach.h"
+#include "event.h"
+#include "task.h"
+#include "telemetry.h"
+#include "history.h"
+#include "kv_store.h"
+#include "evlog.h"
+#include "rate.h"
+#include "fault.h"
+#include "keypad.h"
+#include "ADC.h"
+#include "dwt.h"
+#include "timer.h"
+#include "prof.h"
+#include "trace.h"
+
+#define BENCH_RUNS 100
+#define LOG_DEFAULT_COUNT 10
+#define LOG_MAX_COUNT 32		//keeps a listing within the transmit buffer
+#define FAULT_TEST_ADDR 0xC0000000	//unmapped, reading it is a precise bus fault
+
+static void cmd_help(int argc, char **argv);
+static void cmd_get(int argc, char **argv);
+static void cmd_set(int argc, char **argv);
+static void cmd_stats(int argc, char **argv);
+static void cmd_loads(int argc, char **argv);
+static void cmd_telemetry(int argc, char **argv);
+static void cmd_bench(int argc, char **argv);
+static void cmd_history(int argc, char **argv);
+static void cmd_config(int argc, char **argv);
+static void cmd_log(int argc, char **argv);
+static void cmd_summary(int argc, char **argv);
+static void cmd_fault(int argc, char **argv);
+static void cmd_trace(int argc, char **argv);
+#ifdef PROFILE
+static void cmd_prof(int argc, char **argv);
+#endif
+
+static const ShellCommand commands[] = {
+	{"help",		"help",									cmd_help},
+	{"get",			"get threshold [led|fan|siren] | get rate",	cmd_get},
+	{"set",			"set threshold <load> <on|off|minon|minoff> <value> | set rate <on|off|loads> <value>",	cmd_set},
+	{"stats",		"stats [clear]",						cmd_stats},
+	{"loads",		"loads",								cmd_loads},
+	{"telemetry",	"telemetry <on|off>",					cmd_telemetry},
+	{"bench",		"bench",								cmd_bench},
+	{"history",		"history [dump]",						cmd_history},
+	{"config",		"config [save|erase]",					cmd_config},
+	{"log",			"log [count]",							cmd_log},
+	{"summary",		"summary [yesterday|clear]",			cmd_summary},
+	{"fault",		"fault [test]",							cmd_fault},
+	{"trace",		"trace [dump|freeze|arm [<id> [post]]]",	cmd_trace},
+#ifdef PROFILE
+	{"prof",		"prof [clear]",							cmd_prof},
+#endif
+};
+#define NUM_COMMANDS (sizeof(commands) / sizeof(commands[0]))
+
+static const char *load_names[NUM_LOADS] = {"led", "fan", "siren"};
+
+static Rule *rule_table;
+static RuleState *rule_states;
+static uint8_t rule_count;
+static int8_t history_task;
+static int8_t trace_task;
+static RateTrip *rate_trip;
+static const RateEstimator *rate_estimator;
+static Stats *day_stats;
+
+static int split(char *line, char **argv);
+static int find_load(const char *name);
+static int parse_milli(const char *text, int32_t *value);
+static int parse_uint(const char *text, uint32_t *value);
+static void print_milli(int32_t value);
+static void print_rule(const Rule *rule);
+static void print_rate(const RateTrip *trip);
+static void cmd_set_rate(int argc, char **argv);
+static void print_pair(const char *label, int32_t value);
+
+/*
+ * This function gives the shell access to the load rule table so thresholds can
+ * be read and changed at run time.
+ * Inputs:
+ * 		*rules - rule table
+ * 		*states - rule state array
+ * 		count - number of rules
+ * 		*trip - rate of rise trip
+ * 		*estimator - rate of rise estimate feeding the trip
+ * 		*days - temperature statistics, today then yesterday
+ * Outputs:
+ * 		none
+ */
+void shell_init(Rule *rules, RuleState *states, uint8_t count, RateTrip *trip, const RateEstimator *estimator, Stats *days){
+	rule_table = rules;
+	rule_states = states;
+	rule_count = count;
+	rate_trip = trip;
+	rate_estimator = estimator;
+	day_stats = days;
+	history_task = task_add(history_dump_pt);
+	trace_task = task_add(trace_dump_pt);
+	usart2_print_string(SHELL_PROMPT);
+}
+
+/*
+ * This function runs one command line. The line is modified in place.
+ * Inputs:
+ * 		*line - null terminated command line
+ * Outputs:
+ * 		none
+ */
+void shell_execute(char *line){
+	char *argv[SHELL_MAX_ARGS];
+	int argc = split(line, argv);
+
+	if(argc > 0){
+		unsigned int i;
+		for(i = 0; i < NUM_COMMANDS; i++){
+			if(strcmp(argv[0], commands[i].name) == 0){
+				PROF_BEGIN(PROF_SHELL);
+				commands[i].handler(argc, argv);
+				PROF_END(PROF_SHELL);
+				break;
+			}
+		}
+		if(i == NUM_COMMANDS){
+			usart2_print_string("unknown command, try help\r\n");
+		}
+	}
+	usart2_print_string(SHELL_PROMPT);
+}
+
+static void cmd_help(int argc, char **argv){
+	for(unsigned int i = 0; i < NUM_COMMANDS; i++){
+		usart2_print_string(commands[i].usage);
+		usart2_print_string("\r\n");
+	}
+}
+
+static void cmd_get(int argc, char **argv){
+	if(argc >= 2 && strcmp(argv[1], "rate") == 0){
+		print_rate(rate_trip);
+		return;
+	}
+	if(argc < 2 || strcmp(argv[1], "threshold") != 0){
+		usart2_print_string("usage: get threshold [load] | get rate\r\n");
+		return;
+	}
+
+	int only = -1;
+	if(argc >= 3 && (only = find_load(argv[2])) < 0){
+		return;
+	}
+	for(int i = 0; i < rule_count; i++){
+		if(only < 0 || rule_table[i].load == only){
+			print_rule(&rule_table[i]);
+		}
+	}
+}
+
+static void cmd_set(int argc, char **argv){
+	if(argc >= 2 && strcmp(argv[1], "rate") == 0){
+		cmd_set_rate(argc, argv);
+		return;
+	}
+	if(argc < 5 || strcmp(argv[1], "threshold") != 0){
+		usart2_print_string("usage: set threshold <load> <on|off|minon|minoff> <value>\r\n");
+		return;
+	}
+
+	int load = find_load(argv[2]);
+	if(load < 0){
+		return;
+	}
+	Rule *rule = 0;
+	for(int i = 0; i < rule_count; i++){
+		if(rule_table[i].load == load){
+			rule = &rule_table[i];
+		}
+	}
+	if(rule == 0){
+		usart2_print_string("no rule for load\r\n");
+		return;
+	}
+
+	//thresholds are in degrees, hold times in milliseconds
+	int32_t degrees;
+	uint32_t ms;
+	int ok = 0;
+	if(strcmp(argv[3], "on") == 0 && (ok = parse_milli(argv[4], &degrees))){
+		if(degrees <= rule->off_milliF){
+			usart2_print_string("on must be above off\r\n");
+			return;
+		}
+		rule->on_milliF = degrees;
+	}else if(strcmp(argv[3], "off") == 0 && (ok = parse_milli(argv[4], &degrees))){
+		if(degrees >= rule->on_milliF){
+			usart2_print_string("off must be below on\r\n");
+			return;
+		}
+		rule->off_milliF = degrees;
+	}else if(strcmp(argv[3], "minon") == 0 && (ok = parse_uint(argv[4], &ms))){
+		rule->min_on_ms = ms;
+	}else if(strcmp(argv[3], "minoff") == 0 && (ok = parse_uint(argv[4], &ms))){
+		rule->min_off_ms = ms;
+	}
+
+	if(ok){
+		print_rule(rule);
+	}else{
+		usart2_print_string("bad field or value\r\n");
+	}
+}
+
+/*
+ * Changes the rate of rise trip. Rates are in degrees per minute, and loads is
+ * a comma separated list of load names or "none".
+ */
+static void cmd_set_rate(int argc, char **argv){
+	if(argc < 4){
+		usart2_print_string("usage: set rate <on|off|loads> <value>\r\n");
+		return;
+	}
+
+	int32_t rate;
+	int ok = 0;
+	if(strcmp(argv[2], "on") == 0 && (ok = parse_milli(argv[3], &rate))){
+		rate_trip->on_rate = rate;
+	}else if(strcmp(argv[2], "off") == 0 && (ok = parse_milli(argv[3], &rate))){
+		rate_trip->off_rate = rate;
+	}else if(strcmp(argv[2], "loads") == 0){
+		uint32_t loads = 0;
+		ok = 1;
+		for(char *name = argv[3]; ok && strcmp(name, "none") != 0 && *name != '\0'; ){
+			char *comma = strchr(name, ',');
+			if(comma){
+				*comma = '\0';
+			}
+			int load = find_load(name);
+			ok = load >= 0;
+			loads |= ok ? (1<<load) : 0;
+			name = comma ? comma + 1 : "";
+		}
+		if(ok){
+			rate_trip->loads = loads;
+		}
+	}
+
+	if(ok){
+		print_rate(rate_trip);
+	}else{
+		usart2_print_string("bad field or value\r\n");
+	}
+}
+
+static void cmd_stats(int argc, char **argv){
+	if(argc >= 2 && strcmp(argv[1], "clear") == 0){
+		event_clear_stats();
+		return;
+	}
+
+	//in Event order
+	static const char *event_names[NUM_EVENTS] = {
+		"alarm", "sample", "telemetry", "keypad", "console", "display", "persist", "tasks"
+	};
+	LoopStats loop;
+	event_get_loop_stats(&loop);
+	print_pair("loop passes", loop.iterations);
+	print_pair("idle passes", loop.idle);
+	print_pair("max pass cycles", loop.max_cycles);
+
+	for(int i = 0; i < NUM_EVENTS; i++){
+		EventStats stats;
+		event_get_stats(i, &stats);
+		usart2_print_string(event_names[i]);
+		usart2_print_string(": runs ");
+		usart2_print_num(stats.count);
+		usart2_print_string(" max ");
+		usart2_print_num(stats.max_cycles);
+		usart2_print_string(" avg ");
+		usart2_print_num(stats.count ? stats.total_cycles / stats.count : 0);
+		usart2_print_string("\r\n");
+	}
+
+	TaskStats tasks;
+	task_get_stats(&tasks);
+	print_pair("tasks", tasks.tasks);
+	print_pair("task resumes", tasks.switches);
+	print_pair("max resume cycles", tasks.max_cycles);
+
+	UartErrors errors;
+	usart2_get_errors(&errors);
+	print_pair("uart overrun", errors.overrun);
+	print_pair("uart framing", errors.framing);
+	print_pair("uart noise", errors.noise);
+	print_pair("uart lost lines", errors.lost_lines);
+	print_pair("uart tx dropped", usart2_tx_dropped());
+	TachCounts tach;
+	tach_get_counts(&tach);
+	print_pair("tach pulses", tach.pulses);
+	print_pair("tach rejected", tach.rejected);
+	print_pair("tach masked", tach.masked);
+	print_pair("tach overcaptures", tach.overcaptures);
+}
+
+static void cmd_loads(int argc, char **argv){
+	usart2_print_string("temp ");
+	print_milli(control_get_milliF());
+	usart2_print_string("\r\n");
+	for(int i = 0; i < rule_count; i++){
+		Load load = rule_table[i].load;
+		usart2_print_string(load_names[load]);
+		usart2_print_string(rule_states[i].active ? ": on, duty " : ": off, duty ");
+		usart2_print_num(pwm_get_duty(load));
+		usart2_print_string("\r\n");
+	}
+	usart2_print_string("fan rpm ");
+	usart2_print_num(tach_get_rpm());
+	usart2_print_string(tach_stalled() ? ", stalled\r\n" : "\r\n");
+	usart2_print_string(rate_valid(rate_estimator) ? "rate " : "rate (filling) ");
+	print_milli(rate_per_minute(rate_estimator, RATE_PERIOD));
+	usart2_print_string(rate_trip->active ? "/min, tripped\r\n" : "/min\r\n");
+}
+
+static void cmd_telemetry(int argc, char **argv){
+	if(argc >= 2){
+		telemetry_enable(strcmp(argv[1], "on") == 0);
+	}
+	usart2_print_string(telemetry_enabled() ? "telemetry on\r\n" : "telemetry off\r\n");
+}
+
+/*
+ * Times the cheap driver and control paths with the cycle counter. Each is run
+ * BENCH_RUNS times and the average is reported, so the command takes well
+ * under a millisecond.
+ */
+static void cmd_bench(int argc, char **argv){
+	uint32_t start;
+	volatile uint32_t sink = 0;
+
+	start = DWT_CYCLES();
+	for(int i = 0; i < BENCH_RUNS; i++){
+		sink += key_getkey_noblock();
+	}
+	print_pair("key scan cycles", (DWT_CYCLES() - start) / BENCH_RUNS);
+
+	start = DWT_CYCLES();
+	for(int i = 0; i < BENCH_RUNS; i++){
+		sink += adc_to_milliF(i * 40);
+	}
+	print_pair("adc convert cycles", (DWT_CYCLES() - start) / BENCH_RUNS);
+
+	RuleState states[NUM_LOADS];
+	rules_init(rule_table, states, rule_count, 0);
+	start = DWT_CYCLES();
+	for(int i = 0; i < BENCH_RUNS; i++){
+		sink += rules_evaluate(rule_table, states, rule_count, i * 100, i);
+	}
+	print_pair("rule pass cycles", (DWT_CYCLES() - start) / BENCH_RUNS);
+	(void)sink;
+}
+
+/*
+ * Summarizes the sample history, or streams all of it as CSV. The dump runs as
+ * a task so it can wait for the transmit buffer without stalling the loop.
+ */
+static void cmd_history(int argc, char **argv){
+	if(argc >= 2 && strcmp(argv[1], "dump") == 0){
+		if(history_task >= 0 && !task_active(history_task)){
+			task_start(history_task);
+			event_post(EVT_TASKS);
+		}else{
+			usart2_print_string("dump busy\r\n");
+		}
+		return;
+	}
+
+	HistoryInfo info;
+	history_get_info(&info);
+	print_pair("samples", info.samples);
+	print_pair("bytes", info.bytes);
+	print_pair("oldest s", info.oldest_s);
+	print_pair("newest s", info.newest_s);
+	print_pair("dropped", info.dropped);
+}
+
+/*
+ * Reports the settings store, writes pending changes now, or erases it so the
+ * defaults and a new power-on temperature are used from the next boot. Neither
+ * erases a flash sector, so the loads keep running.
+ */
+static void cmd_config(int argc, char **argv){
+	if(argc >= 2 && strcmp(argv[1], "save") == 0){
+		event_post(EVT_PERSIST);
+		return;
+	}
+	KvInfo info;
+	kv_get_info(&info);
+	if(argc >= 2 && strcmp(argv[1], "erase") == 0){
+		if(!info.spare){
+			usart2_print_string("no erased sector until the next boot\r\n");
+			return;
+		}
+		usart2_print_string(kv_erase() == 0 ? "erased\r\n" : "flash error\r\n");
+		return;
+	}
+
+	print_pair("keys", info.keys);
+	print_pair("pending", info.pending);
+	print_pair("bytes used", info.used);
+	print_pair("generation", info.generation);
+	print_pair("bad records", info.bad);
+	print_pair("spare ready", info.spare);
+}
+
+/*
+ * Lists the newest events in the flash log, newest first. Buffered events are
+ * written out first so the list is current.
+ */
+static void cmd_log(int argc, char **argv){
+	static const char *type_names[] = {"?", "reset", "alarm on", "alarm off", "fault", "config", "rate on", "rate off"};
+	uint32_t count = LOG_DEFAULT_COUNT;
+	if(argc >= 2 && (!parse_uint(argv[1], &count) || count > LOG_MAX_COUNT)){
+		usart2_print_string("usage: log [count], count up to 32\r\n");
+		return;
+	}
+
+	evlog_flush();
+	EvlogInfo info;
+	evlog_get_info(&info);
+	print_pair("records", info.records);
+	print_pair("dropped", info.dropped);
+
+	for(uint32_t back = 0; back < count && back < info.records; back++){
+		EvlogRecord record;
+		if(!evlog_read(back, &record)){
+			usart2_print_string("torn record\r\n");
+			continue;
+		}
+		usart2_print_num(record.seq);
+		usart2_print_string(" ");
+		usart2_print_num(record.time_ms);
+		usart2_print_string("ms ");
+		usart2_print_string(type_names[record.type <= EVLOG_RATE_OFF ? record.type : 0]);
+		usart2_print_string(" ");
+		usart2_print_num(record.arg);
+		usart2_print_string(record.data < 0 ? " -" : " ");
+		usart2_print_num(record.data < 0 ? -record.data : record.data);
+		usart2_print_string("\r\n");
+	}
+}
+
+/*
+ * Prints today's or yesterday's temperature statistics: the mean and spread,
+ * the extremes with the time they were seen, time spent above each load's trip
+ * point and the histogram bins that have samples. Times are seconds since
+ * start up.
+ */
+static void cmd_summary(int argc, char **argv){
+	Stats *stats = &day_stats[0];
+	if(argc >= 2 && strcmp(argv[1], "clear") == 0){
+		stats_init(stats, get_time_ms());
+		return;
+	}
+	if(argc >= 2 && strcmp(argv[1], "yesterday") == 0){
+		stats = &day_stats[1];
+	}
+
+	print_pair("samples", stats->count);
+	print_pair("seconds", (stats->last_ms - stats->start_ms) / 1000);
+	if(stats->count == 0){
+		return;
+	}
+	usart2_print_string("mean ");
+	print_milli(stats_mean(stats));
+	usart2_print_string(" sd ");
+	print_milli(stats_stddev(stats));
+	usart2_print_string("\r\nmin ");
+	print_milli(stats->min);
+	usart2_print_string(" at ");
+	usart2_print_num(stats->min_ms / 1000);
+	usart2_print_string("s\r\nmax ");
+	print_milli(stats->max);
+	usart2_print_string(" at ");
+	usart2_print_num(stats->max_ms / 1000);
+	usart2_print_string("s\r\n");
+
+	for(int i = 0; i < NUM_LOADS && i < STATS_THRESHOLDS; i++){
+		usart2_print_string(load_names[i]);
+		usart2_print_string(" trip ");
+		print_milli(stats->thresholds[i]);
+		usart2_print_string(", above for ");
+		usart2_print_num(stats->above_ms[i] / 1000);
+		usart2_print_string("s\r\n");
+	}
+
+	for(int bin = 0; bin < STATS_BINS; bin++){
+		if(stats->bins[bin] == 0){
+			continue;
+		}
+		if(bin == 0){
+			usart2_print_string("below ");
+			print_milli(stats_bin_low(1));
+		}else{
+			print_milli(stats_bin_low(bin));
+			usart2_print_string(bin == STATS_BINS - 1 ? " and up" : "");
+		}
+		usart2_print_string(": ");
+		usart2_print_num(stats->bins[bin]);
+		usart2_print_string("\r\n");
+	}
+}
+
+/*
+ * Prints the crash record from the last fault and the number of crashes
+ * recovered from. 'fault test' reads an unmapped address to exercise the
+ * fault handler, which turns the loads off and resets.
+ */
+static void cmd_fault(int argc, char **argv){
+	if(argc >= 2 && strcmp(argv[1], "test") == 0){
+		volatile uint32_t sink = *(volatile uint32_t*)FAULT_TEST_ADDR;
+		(void)sink;
+		return;
+	}
+
+	int32_t faults = 0;
+	kv_get(KV_KEY_FAULTS, &faults);
+	print_pair("faults", faults);
+	const FaultRecord *fault = fault_get();
+	if(fault != 0){
+		fault_print(fault);
+	}
+}
+
+/*
+ * Shows the state of the trace buffer, writes it to the console, freezes it,
+ * or empties it and starts recording again with an optional trigger id that
+ * freezes it a number of records later.
+ */
+static void cmd_trace(int argc, char **argv){
+	static const char *trace_names[NUM_TRACE_IDS] = TRACE_NAMES;
+	if(argc >= 2 && strcmp(argv[1], "dump") == 0){
+		if(trace_task >= 0 && !task_active(trace_task)){
+			task_start(trace_task);
+			event_post(EVT_TASKS);
+		}else{
+			usart2_print_string("dump busy\r\n");
+		}
+		return;
+	}
+	if(argc >= 2 && strcmp(argv[1], "freeze") == 0){
+		trace_freeze();
+	}else if(argc >= 2 && strcmp(argv[1], "arm") == 0){
+		uint16_t trigger = TRACE_NO_TRIGGER;
+		uint32_t post = TRACE_SIZE / 2;
+		if(argc >= 3){
+			for(trigger = 0; trigger < NUM_TRACE_IDS; trigger++){
+				if(strcmp(argv[2], trace_names[trigger]) == 0){
+					break;
+				}
+			}
+			if(trigger == NUM_TRACE_IDS || (argc >= 4 && (!parse_uint(argv[3], &post) || post >= TRACE_SIZE))){
+				usart2_print_string("bad id or post count\r\n");
+				return;
+			}
+		}
+		trace_arm(trigger, post);
+	}else if(argc >= 2){
+		usart2_print_string("usage: trace [dump|freeze|arm [<id> [post]]]\r\n");
+		return;
+	}
+
+	TraceInfo info;
+	trace_get_info(&info);
+	print_pair("records", info.records);
+	usart2_print_string("trigger ");
+	usart2_print_string(info.trigger < NUM_TRACE_IDS ? trace_names[info.trigger] : "none");
+	usart2_print_string(info.triggered ? ", seen\r\n" : "\r\n");
+	usart2_print_string(info.frozen ? "frozen\r\n" : "recording\r\n");
+}
+
+#ifdef PROFILE
+/*
+ * Lists each profiled zone that has run, with its run count and shortest,
+ * average and longest cycles, then the nonzero histogram bins as the lower
+ * bound of the bin and the runs in it.
+ */
+static void cmd_prof(int argc, char **argv){
+	if(argc >= 2 && strcmp(argv[1], "clear") == 0){
+		prof_clear();
+		return;
+	}
+
+	//in ProfZone order
+	static const char *zone_names[NUM_PROF_ZONES] = {
+		"control", "pid", "rules", "stats", "format", "lcd wait", "persist", "shell"
+	};
+	for(int i = 0; i < NUM_PROF_ZONES; i++){
+		ProfStats stats;
+		prof_get(i, &stats);
+		if(stats.count == 0){
+			continue;
+		}
+		usart2_print_string(zone_names[i]);
+		usart2_print_string(": runs ");
+		usart2_print_num(stats.count);
+		usart2_print_string(" min ");
+		usart2_print_num(stats.min_cycles);
+		usart2_print_string(" avg ");
+		usart2_print_num(stats.total_cycles / stats.count);
+		usart2_print_string(" max ");
+		usart2_print_num(stats.max_cycles);
+		usart2_print_string("\r\n ");
+		for(int bin = 0; bin < PROF_BINS; bin++){
+			if(stats.hist[bin] != 0){
+				usart2_print_string(" ");
+				usart2_print_num(prof_bin_low(bin));
+				usart2_print_string(":");
+				usart2_print_num(stats.hist[bin]);
+			}
+		}
+		usart2_print_string("\r\n");
+	}
+}
+#endif
+
+/*
+ * Splits a line into words separated by spaces, in place.
+ */
+static int split(char *line, char **argv){
+	int argc = 0;
+	while(*line != '\0' && argc < SHELL_MAX_ARGS){
+		while(*line == ' '){
+			*line++ = '\0';
+		}
+		if(*line == '\0'){
+			break;
+		}
+		argv[argc++] = line;
+		while(*line != ' ' && *line != '\0'){
+			line++;
+		}
+	}
+	return argc;
+}
+
+static int find_load(const char *name){
+	for(int i = 0; i < NUM_LOADS; i++){
+		if(strcmp(name, load_names[i]) == 0){
+			return i;
+		}
+	}
+	usart2_print_string("unknown load\r\n");
+	return -1;
+}
+
+/*
+ * Parses a decimal number with up to three fraction digits into thousandths.
+ */
+static int parse_milli(const char *text, int32_t *value){
+	int32_t sign = 1;
+	int32_t whole = 0;
+	int32_t frac = 0;
+	int32_t scale = 100;
+	int digits = 0;
+
+	if(*text == '-'){
+		sign = -1;
+		text++;
+	}
+	for(; *text >= '0' && *text <= '9'; text++, digits++){
+		if(whole > 100000){
+			return 0;		//before whole*10 can overflow
+		}
+		whole = whole*10 + (*text - '0');
+	}
+	if(*text == '.'){
+		for(text++; *text >= '0' && *text <= '9'; text++, digits++){
+			frac += (*text - '0') * scale;
+			scale /= 10;
+		}
+	}
+	if(*text != '\0' || digits == 0 || whole > 100000){
+		return 0;
+	}
+	*value = sign * (whole*1000 + frac);
+	return 1;
+}
+
+static int parse_uint(const char *text, uint32_t *value){
+	uint32_t result = 0;
+	if(*text == '\0'){
+		return 0;
+	}
+	for(; *text != '\0'; text++){
+		if(*text < '0' || *text > '9' || result > 100000000){
+			return 0;
+		}
+		result = result*10 + (*text - '0');
+	}
+	*value = result;
+	return 1;
+}
+
+/*
+ * Prints thousandths as a decimal number with three fraction digits.
+ */
+static void print_milli(int32_t value){
+	if(value < 0){
+		usart2_print_string("-");
+		value = -value;
+	}
+	usart2_print_num(value / 1000);
+	usart2_print_string(".");
+	int32_t frac = value % 1000;
+	if(frac < 100){
+		usart2_print_string(frac < 10 ? "00" : "0");
+	}
+	usart2_print_num(frac);
+}
+
+static void print_rule(const Rule *rule){
+	usart2_print_string(load_names[rule->load]);
+	usart2_print_string(": on ");
+	print_milli(rule->on_milliF);
+	usart2_print_string(" off ");
+	print_milli(rule->off_milliF);
+	usart2_print_string(" minon ");
+	usart2_print_num(rule->min_on_ms);
+	usart2_print_string(" minoff ");
+	usart2_print_num(rule->min_off_ms);
+	usart2_print_string("\r\n");
+}
+
+static void print_rate(const RateTrip *trip){
+	usart2_print_string("rate: on ");
+	print_milli(trip->on_rate);
+	usart2_print_string(" off ");
+	print_milli(trip->off_rate);
+	usart2_print_string(" loads");
+	for(int i = 0; i < NUM_LOADS; i++){
+		if(trip->loads & (1<<i)){
+			usart2_print_string(" ");
+			usart2_print_string(load_names[i]);
+		}
+	}
+	usart2_print_string(trip->on_rate == 0 ? " (disabled)\r\n" : "\r\n");
+}
+
+static void print_pair(const char *label, int32_t value){
+	usart2_print_string(label);
+	usart2_print_string(": ");
+	usart2_print_num(value);
+	usart2_print_string("\r\n");
+}
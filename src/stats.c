@@ -0,0 +1,141 @@
+/*
+ * stats.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements running statistics of the temperature: mean, standard
+ * deviation, minimum and maximum with their times, time spent above thresholds
+ * and a histogram. Each sample costs a fixed amount of work and the state is a
+ * fixed size structure, so statistics can be kept over any length of time.
+ */
+
+#include <math.h>
+#include "stats.h"
+
+/*
+ * This function clears the statistics. The thresholds are kept.
+ * Inputs:
+ * 		*stats - statistics
+ * 		now_ms - current time in milliseconds
+ * Outputs:
+ * 		none
+ */
+void stats_init(Stats *stats, uint32_t now_ms){
+	stats->start_ms = stats->last_ms = now_ms;
+	stats->count = 0;
+	stats->origin = 0;
+	stats->sum = 0;
+	stats->sum_sq = 0;
+	stats->min = INT32_MAX;
+	stats->max = INT32_MIN;
+	stats->min_ms = stats->max_ms = now_ms;
+	for(int i = 0; i < STATS_THRESHOLDS; i++){
+		stats->above_ms[i] = 0;
+	}
+	for(int i = 0; i < STATS_BINS; i++){
+		stats->bins[i] = 0;
+	}
+}
+
+/*
+ * This function sets a temperature to accumulate time above.
+ * Inputs:
+ * 		*stats - statistics
+ * 		index - threshold number, less than STATS_THRESHOLDS
+ * 		milliF - threshold in thousandths of a degree
+ * Outputs:
+ * 		none
+ */
+void stats_set_threshold(Stats *stats, uint8_t index, int32_t milliF){
+	stats->thresholds[index] = milliF;
+}
+
+/*
+ * This function adds a sample. The time since the previous sample is counted
+ * towards each threshold the new sample is at or above.
+ * Inputs:
+ * 		*stats - statistics
+ * 		milliF - temperature in thousandths of a degree
+ * 		now_ms - time of the sample in milliseconds
+ * Outputs:
+ * 		none
+ */
+void stats_update(Stats *stats, int32_t milliF, uint32_t now_ms){
+	uint32_t elapsed = stats->count ? now_ms - stats->last_ms : 0;
+	stats->last_ms = now_ms;
+	if(stats->count == 0){
+		stats->origin = milliF;
+	}
+	stats->count++;
+
+	//differences from the first sample stay small, so the squares cannot overflow
+	int64_t delta = (int64_t)milliF - stats->origin;
+	stats->sum += delta;
+	stats->sum_sq += delta * delta;
+
+	if(milliF < stats->min){
+		stats->min = milliF;
+		stats->min_ms = now_ms;
+	}
+	if(milliF > stats->max){
+		stats->max = milliF;
+		stats->max_ms = now_ms;
+	}
+
+	for(int i = 0; i < STATS_THRESHOLDS; i++){
+		stats->above_ms[i] += (milliF >= stats->thresholds[i]) ? elapsed : 0;
+	}
+
+	int32_t bin = 1 + (milliF - STATS_BIN_START) / STATS_BIN_WIDTH;
+	if(milliF < STATS_BIN_START){
+		bin = 0;
+	}else if(bin >= STATS_BINS){
+		bin = STATS_BINS - 1;
+	}
+	stats->bins[bin]++;
+}
+
+/*
+ * This function returns the mean temperature.
+ * Inputs:
+ * 		*stats - statistics
+ * Outputs:
+ * 		mean in thousandths of a degree
+ */
+int32_t stats_mean(const Stats *stats){
+	if(stats->count == 0){
+		return 0;
+	}
+	int64_t sum = stats->sum;
+	int64_t half = stats->count / 2;
+	return stats->origin + (sum >= 0 ? (sum + half) / stats->count : (sum - half) / stats->count);
+}
+
+/*
+ * This function returns the sample standard deviation.
+ * Inputs:
+ * 		*stats - statistics
+ * Outputs:
+ * 		standard deviation in thousandths of a degree, 0 with fewer than two samples
+ */
+int32_t stats_stddev(const Stats *stats){
+	if(stats->count < 2){
+		return 0;
+	}
+	double sum = stats->sum;
+	double m2 = stats->sum_sq - sum * sum / stats->count;
+	return m2 > 0 ? lround(sqrt(m2 / (stats->count - 1))) : 0;
+}
+
+/*
+ * This function returns the lower edge of a histogram bin. The first bin holds
+ * everything below STATS_BIN_START and the last everything above its edge.
+ * Inputs:
+ * 		bin - bin number
+ * Outputs:
+ * 		lower edge in thousandths of a degree
+ */
+int32_t stats_bin_low(uint8_t bin){
+	return bin == 0 ? INT32_MIN : STATS_BIN_START + (bin - 1) * STATS_BIN_WIDTH;
+}
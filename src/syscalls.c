@@ -98,32 +98,28 @@ void _exit (int status)
 
 int _read (int file, char *ptr, int len)
 {
-	int DataIdx;
-// Modified the for loop in order to get the correct behavior for fgets
-	int byteCnt = 0;
-	for (DataIdx = 0; DataIdx < len; DataIdx++)
+// Return a complete line from the console without waiting, so fgets never
+// stalls the controller. The line feed is added back for fgets.
+	int byteCnt;
+	if (len <= 0)
+		return 0;
+
+	byteCnt = usart2_readline(ptr, len);
+	if (byteCnt < 0)
 	{
-		//*ptr++ = __io_getchar();
-		byteCnt++;
-		//*ptr++ = usart2_getch();
-		*ptr = usart2_getch();
-		if(*ptr == '\n') break;
-		ptr++;
+		errno = EAGAIN;
+		return -1;
 	}
-
-//return len;
+	if (byteCnt < len - 1)
+		ptr[byteCnt++] = '\n';
 	return byteCnt; // Return byte count
 }
 
 int _write(int file, char *ptr, int len)
 {
-	int DataIdx;
-
-	for (DataIdx = 0; DataIdx < len; DataIdx++)
-	{
-		//__io_putchar(*ptr++);
-		usart2_putch(*ptr++);
-	}
+	// Queue the whole buffer for DMA transmission and return at once. Bytes that
+	// do not fit in the ring are dropped rather than stalling the caller.
+	usart2_write(ptr, len);
 	return len;
 }
 
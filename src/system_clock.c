@@ -0,0 +1,143 @@
+/*
+ * system_clock.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file sets up the clock tree. SystemInit() is called by the reset handler
+ * before main() and switches the core from the 16MHz HSI to the 180MHz PLL,
+ * with the flash wait states, prefetch and caches it needs. Drivers never
+ * assume a clock; they derive prescalers and baud rates from SystemCoreClock
+ * and the bus clock functions here, which read the prescalers back from RCC.
+ */
+
+#include "system_clock.h"
+
+uint32_t SystemCoreClock = HSI_VALUE;
+
+static int wait_set(volatile uint32_t *reg, uint8_t bit);
+
+/*
+ * This function configures the PLL and switches the system clock to it. The
+ * voltage regulator is set to scale 1 with over-drive, which 180MHz requires,
+ * and the flash wait states are raised before the clock is. If the PLL or the
+ * over-drive does not become ready the core is left running from the HSI.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void SystemInit(){
+	//regulator scale 1
+	*(RCC_APB1ENR) |= (1<<PWR_RCCEN_F);
+	*(PWR_CR) |= (PWR_CR_VOS_SCALE1<<PWR_CR_VOS_F);
+
+	//wait states first, then reset and enable the caches and prefetch
+	*(FLASH_ACR) = (CLOCK_WAIT_STATES<<FLASH_ACR_LATENCY_F);
+	*(FLASH_ACR) |= (1<<FLASH_ACR_ICRST_F) | (1<<FLASH_ACR_DCRST_F);
+	*(FLASH_ACR) = (CLOCK_WAIT_STATES<<FLASH_ACR_LATENCY_F) | (1<<FLASH_ACR_PRFTEN_F)
+			| (1<<FLASH_ACR_ICEN_F) | (1<<FLASH_ACR_DCEN_F);
+
+	//PLL from HSI, PLLP field 0 divides by 2
+	*(RCC_PLLCFGR) = CLOCK_PLLM | (CLOCK_PLLN<<RCC_PLLCFGR_PLLN_F) | (((CLOCK_PLLP/2)-1)<<RCC_PLLCFGR_PLLP_F)
+			| (CLOCK_PLLQ<<RCC_PLLCFGR_PLLQ_F) | (CLOCK_PLLR<<RCC_PLLCFGR_PLLR_F);
+	*(RCC_CR) |= (1<<RCC_CR_PLLON_F);
+	if(!wait_set(RCC_CR, RCC_CR_PLLRDY_F)){
+		return;
+	}
+
+	//over-drive for 180MHz
+	*(PWR_CR) |= (1<<PWR_CR_ODEN_F);
+	if(!wait_set(PWR_CSR, PWR_CSR_ODRDY_F)){
+		return;
+	}
+	*(PWR_CR) |= (1<<PWR_CR_ODSWEN_F);
+	if(!wait_set(PWR_CSR, PWR_CSR_ODSWRDY_F)){
+		return;
+	}
+
+	//bus dividers before the switch so APB1 and APB2 never run too fast
+	*(RCC_CFGR) = (CLOCK_PPRE1_DIV4<<RCC_CFGR_PPRE1_F) | (CLOCK_PPRE2_DIV2<<RCC_CFGR_PPRE2_F);
+	*(RCC_CFGR) |= (RCC_CFGR_SW_PLL<<RCC_CFGR_SW_F);
+	for(uint32_t i = 0; i < CLOCK_TIMEOUT; i++){
+		if(((*(RCC_CFGR) >> RCC_CFGR_SWS_F) & 3) == RCC_CFGR_SW_PLL){
+			SystemCoreClock = CLOCK_SYSCLK;
+			return;
+		}
+	}
+}
+
+/*
+ * This function returns the AHB clock, which clocks the core, SysTick and DWT.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		clock in Hz
+ */
+uint32_t clock_get_hclk(){
+	uint32_t hpre = (*(RCC_CFGR) >> RCC_CFGR_HPRE_F) & 0xF;
+	static const uint8_t shift[8] = {1, 2, 3, 4, 6, 7, 8, 9};	//divide by 2 to 512
+	return (hpre & 0x8) ? SystemCoreClock >> shift[hpre & 0x7] : SystemCoreClock;
+}
+
+/*
+ * This function returns the APB1 peripheral clock, which clocks USART2.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		clock in Hz
+ */
+uint32_t clock_get_pclk1(){
+	uint32_t ppre = (*(RCC_CFGR) >> RCC_CFGR_PPRE1_F) & 0x7;
+	return (ppre & 0x4) ? clock_get_hclk() >> ((ppre & 0x3) + 1) : clock_get_hclk();
+}
+
+/*
+ * This function returns the APB2 peripheral clock, which clocks the ADC.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		clock in Hz
+ */
+uint32_t clock_get_pclk2(){
+	uint32_t ppre = (*(RCC_CFGR) >> RCC_CFGR_PPRE2_F) & 0x7;
+	return (ppre & 0x4) ? clock_get_hclk() >> ((ppre & 0x3) + 1) : clock_get_hclk();
+}
+
+/*
+ * This function returns the clock of the APB1 timers(TIM2-7, TIM12-14), which
+ * run at twice the bus clock when the bus is divided.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		clock in Hz
+ */
+uint32_t clock_get_apb1_timer_clk(){
+	uint32_t pclk = clock_get_pclk1();
+	return pclk == clock_get_hclk() ? pclk : 2*pclk;
+}
+
+/*
+ * This function returns the clock of the APB2 timers(TIM1, TIM8-11), which
+ * run at twice the bus clock when the bus is divided.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		clock in Hz
+ */
+uint32_t clock_get_apb2_timer_clk(){
+	uint32_t pclk = clock_get_pclk2();
+	return pclk == clock_get_hclk() ? pclk : 2*pclk;
+}
+
+/*
+ * Polls for a ready bit, giving up after CLOCK_TIMEOUT reads.
+ */
+static int wait_set(volatile uint32_t *reg, uint8_t bit){
+	for(uint32_t i = 0; i < CLOCK_TIMEOUT; i++){
+		if(*reg & (1<<bit)){
+			return 1;
+		}
+	}
+	return 0;
+}
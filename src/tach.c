@@ -0,0 +1,237 @@
+/*
+ * tach.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements the fan tachometer. TIM2 counts at TACH_TIMER_HZ and
+ * captures its count on each rising edge of the tach output, so the period is
+ * timed by the hardware however late the interrupt runs. The capture interrupt
+ * only stores the period since the previous edge. The RPM is worked out when it
+ * is asked for, in integer arithmetic from the median of the last
+ * TACH_FILTER_LEN periods, which drops single missed or doubled pulses.
+ *
+ * The fan is switched on its low side, so while the gate is off in each PWM
+ * cycle the tach output floats. Edges are only taken in the measurement windows
+ * described in tach.h, while the control loop holds the gate on. The input
+ * filter and TACH_MIN_PERIOD_US reject what noise is left.
+ */
+
+#include "tach.h"
+
+#define TACH_RPM_SCALE	((uint32_t)TACH_TIMER_HZ * 60 / TACH_PULSES_PER_REV)
+
+static volatile uint32_t periods[TACH_FILTER_LEN];
+static volatile uint8_t period_count;		//valid entries in periods
+static volatile uint8_t period_next;
+static volatile uint8_t have_edge;			//last_capture holds a recent edge
+static volatile uint32_t last_capture;
+static volatile TachCounts counts;
+static uint8_t armed;						//capture enabled, only used from the control loop
+
+//stall detection state, only used from the main loop
+static uint8_t driven;
+static uint8_t slow;
+static uint8_t stalled;
+static uint32_t driven_since;
+static uint32_t slow_since;
+
+/*
+ * This function starts the tachometer. TIM2 free runs over its full 32 bits at
+ * TACH_TIMER_HZ, and is set up to capture rising edges of PA0. The capture is
+ * left disarmed until tach_window() opens a measurement window.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void tach_init(){
+	enable_clock('A');
+	set_pin_mode('A', TACH_PIN, ALTFUNC);
+	set_alt_func('A', TACH_PIN, TACH_AF);
+	set_pin_PUPDR('A', TACH_PIN, PULLUP);
+
+	*(RCC_APB1ENR) |= (1<<TIM2_RCCEN_F);
+	*(TIM2_PSC) = (clock_get_apb1_timer_clk() / TACH_TIMER_HZ) - 1;
+	*(TIM2_ARR) = 0xFFFFFFFF;
+	*(TIM2_CCMR1) = (TIM_CC1S_TI1<<TIM_CCMR1_CC1S_F) | (TIM_IC1F_DTS32_N8<<TIM_CCMR1_IC1F_F);
+	*(TIM2_CCER) = 0;							//rising edge, disarmed
+	*(TIM2_EGR) = (1<<TIM_EGR_UG_F);			//load the prescaler
+	*(TIM2_SR) = 0;
+	armed = 0;
+	NVIC_PRIORITY(TIM2_IRQn, TACH_IRQ_PRIORITY);
+	NVIC_ENABLE(TIM2_IRQn);
+	*(TIM2_CR1) |= (1<<TIM_CR1_CEN_F);
+}
+
+/*
+ * This function returns the fan speed from the median of the recent periods.
+ * The speed is 0 once a whole measurement window has passed without a pulse.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		revolutions per minute
+ */
+uint32_t tach_get_rpm(){
+	uint32_t sorted[TACH_FILTER_LEN];
+	uint32_t primask = irq_save();
+	uint8_t count = period_count;
+	if(have_edge && *(TIM2_CNT) - last_capture > TACH_TIMEOUT_US){
+		//stopped, the next edge starts a new measurement
+		have_edge = 0;
+		period_count = 0;
+		period_next = 0;
+		count = 0;
+	}
+	for(uint8_t i = 0; i < count; i++){
+		sorted[i] = periods[i];
+	}
+	irq_restore(primask);
+
+	if(count == 0){
+		return 0;
+	}
+
+	//insertion sort, at most TACH_FILTER_LEN entries
+	for(uint8_t i = 1; i < count; i++){
+		uint32_t period = sorted[i];
+		uint8_t j = i;
+		for(; j > 0 && sorted[j-1] > period; j--){
+			sorted[j] = sorted[j-1];
+		}
+		sorted[j] = period;
+	}
+	uint32_t median = sorted[count / 2];
+	return (TACH_RPM_SCALE + median / 2) / median;
+}
+
+/*
+ * This function opens and closes the measurement windows. The capture and its
+ * interrupt are armed once the gate has been held on for TACH_SETTLE_US, and
+ * disarmed when the window ends. Call it from every control loop update.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		1 while the fan must be held on
+ */
+uint8_t tach_window(){
+	uint32_t phase = *(TIM2_CNT) & (TACH_WINDOW_PERIOD_US - 1);
+	uint8_t open = phase >= TACH_SETTLE_US && phase < TACH_WINDOW_US;
+	if(open && !armed){
+		*(TIM2_SR) = ~((1<<TIM_SR_CC1IF_F) | (1<<TIM_SR_CC1OF_F));		//write 0 to clear
+		*(TIM2_CCER) |= (1<<TIM_CCER_CC1E_F);
+		*(TIM2_DIER) |= (1<<TIM_DIER_CC1IE_F);
+	}else if(!open && armed){
+		*(TIM2_DIER) &= ~(1<<TIM_DIER_CC1IE_F);
+		*(TIM2_CCER) &= ~(1<<TIM_CCER_CC1E_F);
+	}
+	armed = open;
+	return phase < TACH_WINDOW_US;
+}
+
+/*
+ * This function watches for a seized fan. Once the fan has been driven at
+ * TACH_STALL_DUTY or more for TACH_SPINUP_MS, it must stay above TACH_STALL_RPM.
+ * If it is slower for TACH_STALL_MS the fan is stalled until it is seen turning
+ * again. Call it at a steady rate with the duty the fan is driven at.
+ * Inputs:
+ * 		fan_duty - fan PWM duty
+ * 		now_ms - current time
+ * Outputs:
+ * 		1 when the fan became stalled or recovered, 0 otherwise
+ */
+uint8_t tach_check_stall(uint16_t fan_duty, uint32_t now_ms){
+	uint8_t was_stalled = stalled;
+	if(fan_duty < TACH_STALL_DUTY){
+		driven = 0;
+		slow = 0;
+		return 0;
+	}
+	if(!driven){
+		driven = 1;
+		driven_since = now_ms;
+	}
+	if(now_ms - driven_since < TACH_SPINUP_MS){
+		return 0;
+	}
+
+	if(tach_get_rpm() >= TACH_STALL_RPM){
+		slow = 0;
+		stalled = 0;
+	}else if(!slow){
+		slow = 1;
+		slow_since = now_ms;
+	}else if(now_ms - slow_since >= TACH_STALL_MS){
+		stalled = 1;
+	}
+	return stalled != was_stalled;
+}
+
+/*
+ * This function reports whether the fan is stalled.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		1 if stalled
+ */
+uint8_t tach_stalled(){
+	return stalled;
+}
+
+/*
+ * This function copies the capture counters.
+ * Inputs:
+ * 		*out - where to store the counters
+ * Outputs:
+ * 		none
+ */
+void tach_get_counts(TachCounts *out){
+	uint32_t primask = irq_save();
+	out->pulses = counts.pulses;
+	out->rejected = counts.rejected;
+	out->masked = counts.masked;
+	out->overcaptures = counts.overcaptures;
+	irq_restore(primask);
+}
+
+/*
+ * TIM2 capture interrupt, stores the period since the previous tach edge in the
+ * same measurement window. Reading the capture register clears the flag.
+ * Periods fill the filter from its first entry after a stop, so the first
+ * period_count entries are valid.
+ */
+void TIM2_IRQHandler(){
+	uint32_t sr = *(TIM2_SR);
+	if(!(sr & (1<<TIM_SR_CC1IF_F))){
+		return;
+	}
+	uint32_t capture = *(TIM2_CCR1);
+	if(sr & (1<<TIM_SR_CC1OF_F)){
+		*(TIM2_SR) = ~(1<<TIM_SR_CC1OF_F);		//write 0 to clear, other flags keep their state
+		counts.overcaptures++;
+	}
+	counts.pulses++;
+
+	//the capture is disarmed up to a control update after the window closes
+	uint32_t phase = capture & (TACH_WINDOW_PERIOD_US - 1);
+	if(phase < TACH_SETTLE_US || phase >= TACH_WINDOW_US){
+		counts.masked++;
+		return;
+	}
+
+	//the first edge of a window only starts the next period
+	uint32_t period = capture - last_capture;
+	if(have_edge && period < TACH_WINDOW_US){
+		if(period < TACH_MIN_PERIOD_US){
+			counts.rejected++;
+			return;
+		}
+		periods[period_next] = period;
+		period_next = (period_next + 1) % TACH_FILTER_LEN;
+		if(period_count < TACH_FILTER_LEN){
+			period_count++;
+		}
+	}
+	have_edge = 1;
+	last_capture = capture;
+}
@@ -0,0 +1,124 @@
+/*
+ * task.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements a cooperative executor for protothreads. Tasks are
+ * registered once and then started whenever there is work for them. Each call to
+ * task_poll() resumes every started task once, and a task stops being polled when
+ * its protothread ends. A task costs three bytes of RAM plus its function pointer.
+ */
+
+#include "task.h"
+
+typedef struct {
+	TaskFn fn;
+	PT pt;
+	uint8_t active;
+} Task;
+
+static Task tasks[MAX_TASKS];
+static uint8_t task_count;
+static uint32_t switches;
+static uint32_t max_cycles;
+static uint32_t total_cycles;
+
+/*
+ * This function registers a protothread with the executor. The task does not
+ * run until it is started.
+ * Inputs:
+ * 		fn - protothread function
+ * Outputs:
+ * 		task id, or -1 if the task table is full
+ */
+int8_t task_add(TaskFn fn){
+	if(task_count >= MAX_TASKS){
+		return -1;
+	}
+	tasks[task_count].fn = fn;
+	tasks[task_count].active = 0;
+	PT_INIT(&tasks[task_count].pt);
+	return task_count++;
+}
+
+/*
+ * This function starts a task from the top of its protothread. Starting a task
+ * that is already running restarts it.
+ * Inputs:
+ * 		id - task id returned by task_add()
+ * Outputs:
+ * 		none
+ */
+void task_start(int8_t id){
+	if(id >= 0 && id < task_count){
+		PT_INIT(&tasks[id].pt);
+		tasks[id].active = 1;
+	}
+}
+
+/*
+ * This function reports whether a task is still running.
+ * Inputs:
+ * 		id - task id returned by task_add()
+ * Outputs:
+ * 		1 if the task has been started and has not finished, 0 otherwise
+ */
+uint8_t task_active(int8_t id){
+	if(id >= 0 && id < task_count){
+		return tasks[id].active;
+	}
+	return 0;
+}
+
+/*
+ * This function resumes every active task once.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		number of tasks still active afterwards
+ */
+uint8_t task_poll(){
+	uint8_t active = 0;
+	for(int i = 0; i < task_count; i++){
+		Task *task = &tasks[i];
+		if(!task->active){
+			continue;
+		}
+
+		uint32_t start = DWT_CYCLES();
+		char state = task->fn(&task->pt);
+		uint32_t cycles = DWT_CYCLES() - start;
+
+		switches++;
+		total_cycles += cycles;
+		if(cycles > max_cycles){
+			max_cycles = cycles;
+		}
+
+		if(PT_SCHEDULE(state)){
+			active++;
+		}else{
+			task->active = 0;
+		}
+	}
+	return active;
+}
+
+/*
+ * This function copies the executor statistics.
+ * Inputs:
+ * 		*stats - where to store the statistics
+ * Outputs:
+ * 		none
+ */
+void task_get_stats(TaskStats *stats){
+	stats->tasks = task_count;
+	stats->active = 0;
+	for(int i = 0; i < task_count; i++){
+		stats->active += tasks[i].active;
+	}
+	stats->switches = switches;
+	stats->max_cycles = max_cycles;
+	stats->total_cycles = total_cycles;
+}
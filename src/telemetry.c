@@ -0,0 +1,69 @@
+/*
+ * telemetry.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file streams binary telemetry frames on the console UART. A frame is
+ * built in a static buffer and handed to the DMA transmit ring, so sending one
+ * costs a CRC and an encode pass over 25 bytes and never waits on the UART.
+ */
+
+#include "telemetry.h"
+#include "control.h"
+#include "pwm.h"
+#include "timer.h"
+#include "uart_driver.h"
+
+static uint16_t seq;
+static uint8_t enabled;
+
+/*
+ * This function turns the telemetry stream on or off.
+ * Inputs:
+ * 		enable - 1 to send frames, 0 to stop
+ * Outputs:
+ * 		none
+ */
+void telemetry_enable(uint8_t enable){
+	enabled = enable;
+}
+
+/*
+ * This function reports whether the telemetry stream is on.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		1 if frames are being sent, 0 otherwise
+ */
+uint8_t telemetry_enabled(){
+	return enabled;
+}
+
+/*
+ * This function captures the current state of the controller and queues a
+ * telemetry frame for it, if the stream is on.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void telemetry_send(){
+	static uint8_t wire[TELEMETRY_WIRE_SIZE];
+	TelemetrySample sample;
+
+	if(!enabled){
+		return;
+	}
+
+	sample.seq = seq++;
+	sample.time_ms = get_time_ms();
+	sample.raw = control_get_raw();
+	sample.temp_milliF = control_get_milliF();
+	sample.offset_milliF = control_get_offset();
+	for(int i = 0; i < TELEMETRY_LOADS; i++){
+		sample.duty[i] = pwm_get_duty(i);
+	}
+
+	usart2_write((const char *)wire, telemetry_pack(&sample, wire));
+}
@@ -0,0 +1,105 @@
+/*
+ * telemetry_frame.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file converts telemetry samples to and from their framed wire format. It
+ * has no hardware dependencies and is shared with the host side decoder.
+ */
+
+#include "telemetry.h"
+#include "cobs.h"
+
+static uint8_t *put16(uint8_t *p, uint16_t value);
+static uint8_t *put32(uint8_t *p, uint32_t value);
+static uint16_t get16(const uint8_t *p);
+static uint32_t get32(const uint8_t *p);
+
+/*
+ * This function builds the complete wire frame for a sample: the serialized
+ * fields and CRC, COBS encoded, between two zero delimiters. The leading zero
+ * means a frame survives any console text written just before it.
+ * Inputs:
+ * 		*sample - sample to send
+ * 		*wire - output buffer, TELEMETRY_WIRE_SIZE bytes
+ * Outputs:
+ * 		number of bytes written to wire
+ */
+uint32_t telemetry_pack(const TelemetrySample *sample, uint8_t *wire){
+	uint8_t frame[TELEMETRY_FRAME_SIZE];
+	uint8_t *p = frame;
+
+	*p++ = TELEMETRY_TYPE_SAMPLE;
+	p = put16(p, sample->seq);
+	p = put32(p, sample->time_ms);
+	p = put16(p, sample->raw);
+	p = put32(p, sample->temp_milliF);
+	p = put32(p, sample->offset_milliF);
+	for(int i = 0; i < TELEMETRY_LOADS; i++){
+		p = put16(p, sample->duty[i]);
+	}
+	put16(p, crc16_ccitt(frame, TELEMETRY_PAYLOAD_SIZE, 0xFFFF));
+
+	wire[0] = 0;
+	uint32_t len = cobs_encode(frame, TELEMETRY_FRAME_SIZE, &wire[1]);
+	wire[len+1] = 0;
+	return len + 2;
+}
+
+/*
+ * This function decodes one COBS encoded frame, without its delimiters, back
+ * into a sample.
+ * Inputs:
+ * 		*encoded - encoded frame
+ * 		len - length of the encoded frame
+ * 		*sample - where to store the sample
+ * Outputs:
+ * 		0 on success, -1 for bad COBS or length, -2 for a CRC mismatch, -3 for
+ * 		an unknown frame type
+ */
+int telemetry_unpack(const uint8_t *encoded, uint32_t len, TelemetrySample *sample){
+	uint8_t frame[TELEMETRY_FRAME_SIZE + 4];
+	if(len > sizeof(frame) || cobs_decode(encoded, len, frame) != TELEMETRY_FRAME_SIZE){
+		return -1;
+	}
+	if(crc16_ccitt(frame, TELEMETRY_PAYLOAD_SIZE, 0xFFFF) != get16(&frame[TELEMETRY_PAYLOAD_SIZE])){
+		return -2;
+	}
+	if(frame[0] != TELEMETRY_TYPE_SAMPLE){
+		return -3;
+	}
+
+	const uint8_t *p = &frame[1];
+	sample->seq = get16(p);
+	sample->time_ms = get32(p+2);
+	sample->raw = get16(p+6);
+	sample->temp_milliF = (int32_t)get32(p+8);
+	sample->offset_milliF = (int32_t)get32(p+12);
+	for(int i = 0; i < TELEMETRY_LOADS; i++){
+		sample->duty[i] = get16(p+16+2*i);
+	}
+	return 0;
+}
+
+static uint8_t *put16(uint8_t *p, uint16_t value){
+	p[0] = value;
+	p[1] = value >> 8;
+	return p + 2;
+}
+
+static uint8_t *put32(uint8_t *p, uint32_t value){
+	p[0] = value;
+	p[1] = value >> 8;
+	p[2] = value >> 16;
+	p[3] = value >> 24;
+	return p + 4;
+}
+
+static uint16_t get16(const uint8_t *p){
+	return p[0] | (p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t *p){
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
@@ -1,5 +1,7 @@
 #include "timer.h"
 
+static volatile uint32_t time_ms;
+
 /*
  *	Delay the processor by t_ms by
  *	polling the Systick timer.
@@ -15,8 +17,8 @@ void delay_ms(uint32_t t_ms){
 	for(uint32_t i=0; i<t_ms; i++){
 		
 	
-		//load 16000 into STK_LOAD
-		*(STK_LOAD) = 16000;//1ms
+		//load one millisecond of core clocks into STK_LOAD
+		*(STK_LOAD) = SystemCoreClock / 1000;//1ms
 		
 		//turn on counter
 		*(STK_CTRL) |= ((1<<STK_ENABLE_F) | (1<<STK_CLKSOURCE_F));
@@ -44,8 +46,8 @@ void delay_us(uint32_t t_us){
 	for(uint32_t i=0; i<t_us; i++){
 		
 	
-		//load 16 into STK_LOAD
-		*(STK_LOAD) = 16;//1us
+		//load one microsecond of core clocks into STK_LOAD
+		*(STK_LOAD) = SystemCoreClock / 1000000;//1us
 		
 		//turn on counter
 		*(STK_CTRL) |= ((1<<STK_ENABLE_F) | (1<<STK_CLKSOURCE_F));
@@ -57,3 +59,47 @@ void delay_us(uint32_t t_us){
 		*(STK_CTRL) &= ~(1<<STK_ENABLE_F);
 	}
 }
+
+/*
+ *	Start the millisecond tick. TIM7 interrupts once
+ *	per millisecond and advances the time returned
+ *	by get_time_ms().
+ *	inputs:
+ *			none
+ *	outputs:
+ *			none
+*/
+void tick_init(){
+	time_ms = 0;
+	
+	//TIM7 counts at 1MHz and overflows every millisecond
+	*(RCC_APB1ENR) |= (1<<TIM7_RCCEN_F);
+	*(TIM7_PSC) = (clock_get_apb1_timer_clk() / 1000000) - 1;
+	*(TIM7_ARR) = 1000 - 1;
+	*(TIM7_DIER) |= (1<<TIM7_UIE_F);
+	NVIC_PRIORITY(TIM7_IRQn, TICK_IRQ_PRIORITY);
+	NVIC_ENABLE(TIM7_IRQn);
+	*(TIM7_CR1) |= (1<<TIM7_CEN_F);
+}
+
+/*
+ *	Returns the number of milliseconds since
+ *	tick_init() was called. Wraps after 49 days.
+ *	inputs:
+ *			none
+ *	outputs:
+ *			milliseconds since start
+*/
+uint32_t get_time_ms(){
+	return time_ms;
+}
+
+/*
+ *	TIM7 update interrupt, advances the millisecond tick
+ *	and runs the watchdog liveness checks.
+*/
+void TIM7_IRQHandler(){
+	*(TIM7_SR) &= ~(1<<TIM7_UIF_F);
+	time_ms++;
+	watchdog_tick();
+}
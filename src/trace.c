@@ -0,0 +1,169 @@
+/*
+ * trace.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements the trace buffer. trace() writes fixed size records of
+ * an id, a cycle count timestamp and a 16 bit argument into a RAM ring, from
+ * any context. The ring can be frozen by a trigger id, keeping a set number of
+ * records after it, so the lead up to an event survives until it is dumped.
+ *
+ * The dump is text, so it can share the console with the shell:
+ * 		trace <records> <core clock Hz>
+ * 		<cycles, 8 hex digits><arg and id, 8 hex digits>	one line per record, oldest first
+ * 		trace end
+ * tools/trace_decode.c turns it back into times and names.
+ */
+
+#include "trace.h"
+#include "nvic.h"
+#include "system_clock.h"
+#include "uart_driver.h"
+
+TraceRecord trace_buffer[TRACE_SIZE];
+volatile uint32_t trace_head;
+volatile uint8_t trace_frozen;
+volatile uint16_t trace_trigger = TRACE_NO_TRIGGER;
+volatile uint16_t trace_countdown;
+
+static uint16_t trigger_post;
+static uint16_t armed_trigger = TRACE_NO_TRIGGER;
+
+static void print_record(const TraceRecord *record);
+
+/*
+ * This function is called by trace() when the trigger id is seen, and for
+ * every record after it until the buffer freezes.
+ * Inputs:
+ * 		id - id just recorded
+ * Outputs:
+ * 		none
+ */
+void trace_fire(uint16_t id){
+	uint32_t primask = irq_save();
+	if(trace_countdown != 0){
+		if(--trace_countdown == 0){
+			trace_frozen = 1;
+		}
+	}else if(id == trace_trigger){
+		trace_trigger = TRACE_NO_TRIGGER;
+		trace_countdown = trigger_post;
+		if(trigger_post == 0){
+			trace_frozen = 1;
+		}
+	}
+	irq_restore(primask);
+}
+
+/*
+ * This function empties the buffer and starts recording again.
+ * Inputs:
+ * 		trigger - TraceId that freezes the buffer, or TRACE_NO_TRIGGER to record
+ * 		until trace_freeze() is called
+ * 		post - records kept after the trigger before freezing
+ * Outputs:
+ * 		none
+ */
+void trace_arm(uint16_t trigger, uint16_t post){
+	uint32_t primask = irq_save();
+	trace_head = 0;
+	trace_countdown = 0;
+	trigger_post = post;
+	armed_trigger = trigger;
+	trace_trigger = trigger;
+	trace_frozen = 0;
+	irq_restore(primask);
+}
+
+/*
+ * This function stops recording, keeping the buffer contents.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void trace_freeze(){
+	trace_frozen = 1;
+}
+
+/*
+ * This function reports the state of the trace buffer.
+ * Inputs:
+ * 		*info - where to store the state
+ * Outputs:
+ * 		none
+ */
+void trace_get_info(TraceInfo *info){
+	uint32_t primask = irq_save();
+	info->records = trace_head;
+	info->trigger = armed_trigger;
+	info->post = trigger_post;
+	info->triggered = (armed_trigger != TRACE_NO_TRIGGER && trace_trigger == TRACE_NO_TRIGGER);
+	info->frozen = trace_frozen;
+	irq_restore(primask);
+}
+
+/*
+ * Protothread that writes the buffer to the console, oldest record first. The
+ * buffer is frozen while it is written, and recording resumes afterwards unless
+ * it was already frozen.
+ * Inputs:
+ * 		*pt - protothread state
+ * Outputs:
+ * 		protothread state
+ */
+PT_THREAD(trace_dump_pt(PT *pt)){
+	static uint8_t was_frozen;
+	static uint32_t next;
+	static uint32_t end;
+
+	PT_BEGIN(pt);
+	was_frozen = trace_frozen;
+	trace_frozen = 1;
+	end = trace_head;
+	next = end > TRACE_SIZE ? end - TRACE_SIZE : 0;
+
+	//start on a new line, the shell prompt has already been printed
+	PT_WAIT_UNTIL(pt, usart2_tx_free() >= 34);
+	usart2_print_string("\r\ntrace ");
+	usart2_print_num(end - next);
+	usart2_print_string(" ");
+	usart2_print_num(SystemCoreClock);
+	usart2_print_string("\r\n");
+
+	while(next != end){
+		PT_WAIT_UNTIL(pt, usart2_tx_free() >= 20);
+		print_record(&trace_buffer[next % TRACE_SIZE]);
+		next++;
+	}
+
+	PT_WAIT_UNTIL(pt, usart2_tx_free() >= 12);
+	usart2_print_string("trace end\r\n");
+	if(!was_frozen){
+		trace_frozen = 0;
+	}
+	PT_END(pt);
+}
+
+/*
+ * This helper function writes one record as 16 hex digits, the cycle count
+ * then the argument and id.
+ * Inputs:
+ * 		*record - record to write
+ * Outputs:
+ * 		none
+ */
+static void print_record(const TraceRecord *record){
+	char text[19];
+	uint32_t words[2] = {record->cycles, ((uint32_t)record->arg << 16) | record->id};
+	for(int w = 0; w < 2; w++){
+		for(int i = 0; i < 8; i++){
+			text[8*w + i] = "0123456789abcdef"[(words[w] >> (28 - 4*i)) & 0xF];
+		}
+	}
+	text[16] = '\r';
+	text[17] = '\n';
+	text[18] = '\0';
+	usart2_print_string(text);
+}
@@ -0,0 +1,373 @@
+/*
+ * uart_driver.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements the console driver for USART2 on PA2/PA3. Transmitted
+ * bytes are copied into a ring buffer and sent by DMA1 stream 6, so writing to
+ * the console returns as soon as the bytes are queued. Received bytes are moved
+ * into a second ring buffer by the USART2 interrupt, which also assembles them
+ * into complete lines that can be collected without waiting.
+ */
+
+#include <string.h>
+#include "uart_driver.h"
+
+static char tx_buf[USART2_TX_SIZE];
+static volatile uint32_t tx_head;		//next free byte, written by producers
+static volatile uint32_t tx_tail;		//first unsent byte, advanced by the DMA interrupt
+static volatile uint32_t tx_dma_len;	//bytes in the transfer in progress, 0 if idle
+static volatile uint32_t tx_dropped;
+
+static char rx_buf[USART2_RX_SIZE];
+static volatile uint32_t rx_head;
+static volatile uint32_t rx_tail;
+
+static char lines[USART2_LINES][USART2_LINE_SIZE];
+static uint8_t line_len[USART2_LINES];
+static volatile uint32_t line_head;		//next line slot to complete
+static volatile uint32_t line_tail;		//next complete line to read
+static uint8_t edit_len;				//length of the line being typed
+static uint8_t echo;
+static UartLineCallback line_callback;
+static UartErrors errors;
+
+static void start_tx_dma();
+static void receive_line_char(char c);
+
+/*
+ * This function initializes USART2 for 8N1 communication at the baud rate given,
+ * with DMA transmission and interrupt driven reception.
+ * Inputs:
+ * 		baud - baud rate
+ * 		sysclk - clock of the APB1 bus USART2 runs from
+ * Outputs:
+ * 		none
+ */
+void init_usart2(uint32_t baud, uint32_t sysclk){
+	//enable clocks for GPIOA, DMA1 and USART2
+	*(RCC_AHB1ENR) |= (1<<GPIOAEN) | (1<<DMA1EN);
+	*(RCC_APB1ENR) |= (1<<USART2EN);
+
+	//PA2 and PA3 to alternate function 7
+	*(GPIOA_MODER) = (*(GPIOA_MODER) & ~(0xF<<4)) | (0xA<<4);
+	*(GPIOA_AFRL) = (*(GPIOA_AFRL) & ~(0xFF<<8)) | (0x77<<8);
+
+	tx_head = tx_tail = tx_dma_len = 0;
+	rx_head = rx_tail = 0;
+	line_head = line_tail = 0;
+	edit_len = 0;
+
+	//baud rate register holds sysclk/baud with 4 fraction bits, rounded
+	*(USART_BRR) = (sysclk + baud/2) / baud;
+	*(USART_CR3) = (1<<DMAT) | (1<<EIE);
+	*(USART_CR1) = (1<<UE) | (1<<TE) | (1<<RE) | (1<<RXNEIE);
+
+	//DMA1 stream 6 channel 4, memory to USART2 data register
+	*(DMA1_S6CR) = 0;
+	*(DMA1_HIFCR) = DMA_S6_FLAGS;
+	*(DMA1_S6PAR) = (uint32_t)(uintptr_t)USART_DR;
+	*(DMA1_S6CR) = (4<<DMA_CHSEL) | (1<<DMA_MINC) | (1<<DMA_DIR) | (1<<DMA_TCIE) | (1<<DMA_TEIE);
+
+	NVIC_PRIORITY(DMA1_Stream6_IRQn, USART2_IRQ_PRIORITY);
+	NVIC_PRIORITY(USART2_IRQn, USART2_IRQ_PRIORITY);
+	NVIC_ENABLE(DMA1_Stream6_IRQn);
+	NVIC_ENABLE(USART2_IRQn);
+}
+
+/*
+ * This function returns the next received character, waiting until one
+ * arrives.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		character received
+ */
+char usart2_getch(){
+	while(rx_head == rx_tail){}
+	char c = rx_buf[rx_tail & (USART2_RX_SIZE-1)];
+	rx_tail++;
+	return c;
+}
+
+/*
+ * This function returns the number of received characters waiting to be read.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		number of characters in the receive buffer
+ */
+int usart2_rx_count(){
+	return rx_head - rx_tail;
+}
+
+/*
+ * This function copies the oldest complete line received into buf without
+ * waiting. The line terminator is not included and the result is always null
+ * terminated, truncating lines longer than the buffer.
+ * Inputs:
+ * 		*buf - where to store the line
+ * 		size - size of buf
+ * Outputs:
+ * 		length of the line copied, or -1 if no complete line has been received
+ */
+int usart2_readline(char *buf, int size){
+	if(line_head == line_tail || size <= 0){
+		return -1;
+	}
+
+	uint32_t slot = line_tail % USART2_LINES;
+	int len = line_len[slot];
+	if(len > size-1){
+		len = size-1;
+	}
+	memcpy(buf, lines[slot], len);
+	buf[len] = '\0';
+	line_tail++;
+	return len;
+}
+
+/*
+ * This function sets a function the USART2 interrupt calls each time a complete
+ * line has been received. The callback runs in interrupt context and should only
+ * flag the line for later processing.
+ * Inputs:
+ * 		callback - function to call, 0 for none
+ * Outputs:
+ * 		none
+ */
+void usart2_set_line_callback(UartLineCallback callback){
+	line_callback = callback;
+}
+
+/*
+ * This function turns echo of typed characters on or off.
+ * Inputs:
+ * 		on - 1 to echo received characters back, 0 to stay silent
+ * Outputs:
+ * 		none
+ */
+void usart2_set_echo(uint8_t on){
+	echo = on;
+}
+
+/*
+ * This function copies the receive error counters.
+ * Inputs:
+ * 		*out - where to store the counters
+ * Outputs:
+ * 		none
+ */
+void usart2_get_errors(UartErrors *out){
+	*out = errors;
+}
+
+/*
+ * This function queues a single character for transmission.
+ * Inputs:
+ * 		c - character to send
+ * Outputs:
+ * 		none
+ */
+void usart2_putch(char c){
+	usart2_write(&c, 1);
+}
+
+/*
+ * This function copies data into the transmit ring buffer and starts the DMA if
+ * it is idle. It never waits. If the buffer does not have room the bytes that do
+ * not fit are dropped and counted. Safe to call from interrupts.
+ * Inputs:
+ * 		*data - bytes to send
+ * 		len - number of bytes
+ * Outputs:
+ * 		number of bytes queued
+ */
+int usart2_write(const char *data, int len){
+	uint32_t primask = irq_save();
+
+	uint32_t space = USART2_TX_SIZE - (tx_head - tx_tail);
+	if((uint32_t)len > space){
+		tx_dropped += len - space;
+		len = space;
+	}
+
+	//copy in at most two pieces around the end of the buffer
+	uint32_t start = tx_head & (USART2_TX_SIZE-1);
+	uint32_t first = USART2_TX_SIZE - start;
+	if(first > (uint32_t)len){
+		first = len;
+	}
+	memcpy(&tx_buf[start], data, first);
+	memcpy(tx_buf, data + first, len - first);
+	tx_head += len;
+
+	if(tx_dma_len == 0){
+		start_tx_dma();
+	}
+
+	irq_restore(primask);
+	return len;
+}
+
+/*
+ * This function queues a null terminated string for transmission.
+ * Inputs:
+ * 		*pointer - pointer to the character array to be printed
+ * Outputs:
+ * 		length of string/character array.
+ */
+int usart2_print_string(const char *pointer){
+	return usart2_write(pointer, strlen(pointer));
+}
+
+/*
+ * This function queues the decimal representation of an integer for
+ * transmission.
+ * Inputs:
+ * 		num - integer to print
+ * Outputs:
+ * 		number of characters printed
+ */
+int usart2_print_num(int32_t num){
+	char digits[12];
+	int count = sizeof(digits);
+	uint32_t value = (num < 0) ? -(uint32_t)num : (uint32_t)num;
+
+	do{
+		digits[--count] = '0' + (value % 10);
+		value /= 10;
+	}while(value != 0);
+	if(num < 0){
+		digits[--count] = '-';
+	}
+
+	return usart2_write(&digits[count], sizeof(digits) - count);
+}
+
+/*
+ * This function returns the number of bytes dropped because the transmit buffer
+ * was full.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		number of bytes dropped since start up
+ */
+uint32_t usart2_tx_dropped(){
+	return tx_dropped;
+}
+
+/*
+ * This function returns the free space in the transmit buffer, so bulk output
+ * can wait for room instead of being dropped.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		number of bytes that can be written without dropping
+ */
+uint32_t usart2_tx_free(){
+	return USART2_TX_SIZE - (tx_head - tx_tail);
+}
+
+/*
+ * Starts a DMA transfer of the contiguous run of queued bytes starting at the
+ * tail of the ring. Must be called with interrupts disabled or from the DMA
+ * interrupt.
+ */
+static void start_tx_dma(){
+	uint32_t queued = tx_head - tx_tail;
+	if(queued == 0){
+		tx_dma_len = 0;
+		return;
+	}
+
+	uint32_t start = tx_tail & (USART2_TX_SIZE-1);
+	uint32_t len = USART2_TX_SIZE - start;
+	if(len > queued){
+		len = queued;
+	}
+
+	tx_dma_len = len;
+	*(DMA1_S6M0AR) = (uint32_t)(uintptr_t)&tx_buf[start];
+	*(DMA1_S6NDTR) = len;
+	*(DMA1_S6CR) |= (1<<DMA_EN);
+}
+
+/*
+ * DMA1 stream 6 interrupt, a transmit run has finished.
+ */
+void DMA1_Stream6_IRQHandler(){
+	*(DMA1_HIFCR) = DMA_S6_FLAGS;
+	tx_tail += tx_dma_len;
+	start_tx_dma();
+}
+
+/*
+ * USART2 interrupt, moves a received byte into the receive buffer and the line
+ * being assembled. Bytes that arrive while the buffer is full are dropped.
+ * Reading the status register and then the data register clears the error flags.
+ */
+void USART2_IRQHandler(){
+	uint32_t sr = *(USART_SR);
+	if(sr & ((1<<RXNE) | (1<<ORE))){
+		char c = *(USART_DR);
+		errors.overrun += (sr >> ORE) & 1;
+		errors.noise += (sr >> NF) & 1;
+		if(sr & (1<<FE)){
+			errors.framing++;
+			return;
+		}
+		if(!(sr & (1<<RXNE))){
+			return;
+		}
+
+		if(rx_head - rx_tail < USART2_RX_SIZE){
+			rx_buf[rx_head & (USART2_RX_SIZE-1)] = c;
+			rx_head++;
+		}
+		receive_line_char(c);
+	}
+}
+
+/*
+ * Adds a received character to the line being typed. Carriage return or line
+ * feed completes the line, and backspace or delete removes the last character.
+ */
+static void receive_line_char(char c){
+	char *line = lines[line_head % USART2_LINES];
+
+	if(c == '\r' || c == '\n'){
+		if(echo){
+			usart2_write("\r\n", 2);
+		}
+		if(edit_len == 0){
+			return;					//ignore empty lines and the second half of CRLF
+		}
+		if(line_head - line_tail >= USART2_LINES-1){
+			errors.lost_lines++;	//reader is behind, keep typing into this slot
+			edit_len = 0;
+			return;
+		}
+		line_len[line_head % USART2_LINES] = edit_len;
+		line_head++;
+		edit_len = 0;
+		if(line_callback){
+			line_callback();
+		}
+	}else if(c == '\b' || c == 0x7F){
+		if(edit_len > 0){
+			edit_len--;
+			if(echo){
+				usart2_write("\b \b", 3);
+			}
+		}
+	}else if(edit_len < USART2_LINE_SIZE-1){
+		line[edit_len++] = c;
+		if(echo){
+			usart2_write(&c, 1);
+		}
+	}else{
+		errors.long_lines++;
+	}
+}
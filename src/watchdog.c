@@ -0,0 +1,118 @@
+/*
+ * watchdog.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * This file implements the independent watchdog and the liveness checks that
+ * decide whether it is kicked. Each supervised task clears its age with
+ * WATCHDOG_CHECKIN, and every WATCHDOG_PERIOD the millisecond tick ages all of
+ * them. The watchdog is reloaded only while every task is within its deadline,
+ * so a handler spinning on hardware, a display refresh that never completes or
+ * an ADC that stops converting all end in a reset with the loads off. A late
+ * task that recovers before the watchdog expires is forgiven.
+ *
+ * The first late task is kept in RAM that start up does not clear, so the next
+ * boot can say which one caused a watchdog reset.
+ */
+
+#include "watchdog.h"
+
+#define LATE_MAGIC		0x57440000		//upper half of a valid late task record
+#define LATE_MAGIC_MASK	0xFFFF0000
+
+volatile uint8_t watchdog_age[NUM_WATCHDOG_TASKS];
+
+static const uint16_t deadlines[NUM_WATCHDOG_TASKS] = WATCHDOG_DEADLINES;
+static uint16_t tick_count;
+static uint32_t late_task __attribute__((section(".noinit")));
+static int8_t reset_late;
+
+/*
+ * This function starts the independent watchdog. Once started it cannot be
+ * stopped, and the processor resets unless watchdog_tick() keeps reloading it.
+ * The task that was late before the last reset is kept for watchdog_late().
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void watchdog_init(){
+	reset_late = -1;
+	if((late_task & LATE_MAGIC_MASK) == LATE_MAGIC && (late_task & ~LATE_MAGIC_MASK) < NUM_WATCHDOG_TASKS){
+		reset_late = late_task & ~LATE_MAGIC_MASK;
+	}
+	late_task = 0;
+	for(int i = 0; i < NUM_WATCHDOG_TASKS; i++){
+		watchdog_age[i] = 0;
+	}
+	tick_count = 0;
+
+	*(DBGMCU_APB1_FZ) |= (1<<DBG_IWDG_STOP_F);
+	*(IWDG_KR) = IWDG_KEY_START;
+	*(IWDG_KR) = IWDG_KEY_UNLOCK;
+	*(IWDG_PR) = IWDG_PR_DIV128;
+	*(IWDG_RLR) = WATCHDOG_RELOAD;
+	while(*(IWDG_SR) & ((1<<IWDG_SR_PVU_F) | (1<<IWDG_SR_RVU_F))){}
+	*(IWDG_KR) = IWDG_KEY_RELOAD;
+}
+
+/*
+ * This function is called by the millisecond tick. Every WATCHDOG_PERIOD it
+ * ages each task and reloads the watchdog if none is past its deadline.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void watchdog_tick(){
+	if(++tick_count < WATCHDOG_PERIOD){
+		return;
+	}
+	tick_count = 0;
+
+	uint8_t healthy = 1;
+	for(int i = 0; i < NUM_WATCHDOG_TASKS; i++){
+		uint8_t age = watchdog_age[i];
+		if(age < 0xFF){
+			watchdog_age[i] = ++age;
+		}
+		if(age * WATCHDOG_PERIOD > deadlines[i]){
+			if(late_task == 0){
+				late_task = LATE_MAGIC | i;
+			}
+			healthy = 0;
+		}
+	}
+
+	if(healthy){
+		late_task = 0;
+		*(IWDG_KR) = IWDG_KEY_RELOAD;
+	}
+}
+
+/*
+ * This function reloads the watchdog unconditionally. It is only for work known
+ * to block everything for a long but bounded time, such as a flash erase, and
+ * gives it the full watchdog timeout.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		none
+ */
+void watchdog_reload(){
+	*(IWDG_KR) = IWDG_KEY_RELOAD;
+}
+
+/*
+ * This function returns the task that was past its deadline when the watchdog
+ * stopped being reloaded before the last reset. It is only meaningful when
+ * that reset was caused by the watchdog.
+ * Inputs:
+ * 		none
+ * Outputs:
+ * 		WatchdogTask that was late, or -1 if none was recorded
+ */
+int8_t watchdog_late(){
+	return reset_late;
+}
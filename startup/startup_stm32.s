@@ -103,16 +103,16 @@ LoopForever:
 
 /**
  * @brief  This is the code that gets called when the processor receives an
- *         unexpected interrupt.  This simply enters an infinite loop, preserving
- *         the system state for examination by a debugger.
+ *         unexpected interrupt.  It is handled as a fault, so the crash is
+ *         recorded and the processor reset. Without a fault handler linked in,
+ *         HardFault_Handler is this handler and it loops forever.
  *
  * @param  None
  * @retval : None
 */
     .section	.text.Default_Handler,"ax",%progbits
 Default_Handler:
-Infinite_Loop:
-	b	Infinite_Loop
+	b	HardFault_Handler
 	.size	Default_Handler, .-Default_Handler
 /******************************************************************************
 *
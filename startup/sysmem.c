@@ -53,8 +53,32 @@
 extern int errno;
 register char * stack_ptr asm("sp");
 
+/*
+ The firmware has no heap, _Min_Heap_Size is 0 in LinkerScript.ld, so NO_HEAP
+ is on unless the build defines USE_HEAP.
+*/
+#ifndef USE_HEAP
+#define NO_HEAP
+#endif
+
 /* Functions */
 
+#ifdef NO_HEAP
+/**
+ _sbrk
+ The heap is disabled. Every buffer is statically allocated, and nothing in the
+ program should pull in malloc, or the printf family that calls it. Sections are
+ garbage collected(-ffunction-sections, -Wl,--gc-sections), so this _sbrk is only
+ kept if something references it, and then the link fails on the undefined
+ symbol below, naming the problem.
+**/
+extern caddr_t heap_used_in_NO_HEAP_build(int incr);
+
+caddr_t _sbrk(int incr)
+{
+	return heap_used_in_NO_HEAP_build(incr);
+}
+#else
 /**
  _sbrk
  Increase program data space. Malloc and related functions depend on this
@@ -79,4 +103,4 @@ caddr_t _sbrk(int incr)
 
 	return (caddr_t) prev_heap_end;
 }
-
+#endif /* NO_HEAP */
@@ -0,0 +1,105 @@
+#!/bin/sh
+#
+# mem_report.sh
+#
+#  Created on: Oct 19, 2026
+#      Author: Mitchell Larson
+#
+# Prints the flash and RAM each module of the firmware uses, from the linker
+# map, and checks the totals against the memory budget. Link with
+# -Wl,-Map=<file> and run it on the map:
+#
+#     tools/mem_report.sh Debug/FETs-as-DC-Load.map
+#
+# The firmware is built by the IDE project, which is not part of this tree, so
+# nothing here runs the report. Add it to the project's post-build steps.
+#
+# Sizes are taken after section garbage collection, so only code and data that
+# made it into the image are counted. Flash is code, constants and the initial
+# values of .data; RAM is .data, .bss and .noinit. Library members are grouped
+# by archive.
+#
+# The report fails(exit 1) if either total is over budget, or if the image
+# contains malloc, which a NO_HEAP build must not. Budgets can be overridden:
+#     FLASH_BUDGET	flash below the persistent data sectors(default 65536)
+#     RAM_BUDGET	SRAM less the space kept for the stack(default 126976)
+
+MAP="$1"
+FLASH_BUDGET=${FLASH_BUDGET:-65536}
+RAM_BUDGET=${RAM_BUDGET:-126976}
+
+if [ -z "$MAP" ] || [ ! -f "$MAP" ]; then
+	echo "usage: $0 <linker map file>" >&2
+	exit 2
+fi
+
+awk -v flash_budget="$FLASH_BUDGET" -v ram_budget="$RAM_BUDGET" '
+function hex(text,    i, value) {
+	value = 0
+	text = tolower(substr(text, 3))
+	for (i = 1; i <= length(text); i++) {
+		value = value * 16 + index("0123456789abcdef", substr(text, i, 1)) - 1
+	}
+	return value
+}
+function module(file,    name) {
+	name = file
+	sub(/\(.*\)$/, "", name)		# archive member -> archive
+	sub(/.*\//, "", name)
+	sub(/\.o$/, "", name)
+	return name
+}
+function add(file, size,    m) {
+	if (kind == "") return
+	m = module(file)
+	if (kind == "flash" || kind == "data") flash[m] += size
+	if (kind == "ram" || kind == "data") ram[m] += size
+	seen[m] = 1
+	if (file ~ /malloc/) heap = 1
+}
+/^Linker script and memory map/ { inmap = 1; next }
+!inmap { next }
+/^\/DISCARD\// { kind = ""; next }
+
+# output section, e.g. ".text  0x08000000  0x1234"
+/^\.[^ ]/ {
+	name = $1
+	kind = ""
+	if (name ~ /^\.(isr_vector|text|rodata|ARM|ARM\.extab|preinit_array|init_array|fini_array)$/) kind = "flash"
+	else if (name == ".data") kind = "data"
+	else if (name ~ /^\.(bss|noinit)$/) kind = "ram"
+	next
+}
+
+# input section on one line: name address size file
+/^ [^ ]/ && $2 ~ /^0x/ && $3 ~ /^0x/ && NF >= 4 {
+	if ($1 != "*fill*") add($4, hex($3))
+	next
+}
+
+# input section name too long for the line, address size file follow
+$1 ~ /^0x/ && $2 ~ /^0x/ && NF >= 3 {
+	add($3, hex($2))
+	next
+}
+
+END {
+	printf "%-24s %8s %8s\n", "module", "flash", "ram"
+	for (m in seen) {
+		if (flash[m] + ram[m] > 0) {
+			printf "%-24s %8d %8d\n", m, flash[m], ram[m] | "sort -k2 -n -r"
+		}
+		total_flash += flash[m]
+		total_ram += ram[m]
+	}
+	close("sort -k2 -n -r")
+	printf "%-24s %8d %8d\n", "total", total_flash, total_ram
+	printf "%-24s %8d %8d\n", "budget", flash_budget, ram_budget
+
+	status = 0
+	if (total_flash > flash_budget) { print "FLASH OVER BUDGET"; status = 1 }
+	if (total_ram > ram_budget) { print "RAM OVER BUDGET"; status = 1 }
+	if (heap) { print "malloc is linked in, the heap is in use"; status = 1 }
+	exit status
+}
+' "$MAP"
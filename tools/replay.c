@@ -0,0 +1,266 @@
+/*
+ * replay.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * Host replay of recorded temperature traces through the firmware's alarm core.
+ * Reads CSV rows of time and temperature, feeds each to alarm_step() and writes
+ * one CSV row per load or rate trip switching to stdout. A summary with the
+ * trip counts, time on and throughput goes to stderr.
+ *
+ * Times are in seconds, or milliseconds with -m, and temperatures in F. Rows
+ * that do not start with a number, such as a header, are skipped. The power-on
+ * temperature is the first sample unless given. Times are passed to the core on
+ * the firmware's wrapping millisecond clock, so traces may be any length.
+ *
+ * Build:
+ * 		cc -O2 -Iinc -o replay tools/replay.c src/alarm.c src/rules.c src/rate.c
+ * Use:
+ * 		replay [-p power_on_F] [-o offset_F] [-r load,on_F,off_F,min_on_ms,min_off_ms]
+ * 				[-t on_F_per_min,off_F_per_min] [-m] [-q] [trace.csv]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "alarm.h"
+
+#define CHUNK	(1 << 20)
+
+static const char *load_names[NUM_LOADS] = {"led", "fan", "siren"};
+
+typedef struct {
+	uint64_t trips;
+	uint64_t on_ms;
+	uint64_t first_ms;
+	uint64_t since_ms;
+} LoadSummary;
+
+static int parse_milli(const char **text, int64_t *value);
+static int parse_rule(const char *text, Rule *rules);
+static void usage();
+
+int main(int argc, char **argv){
+	static Rule rules[NUM_LOADS] = ALARM_DEFAULT_RULES;
+	static RateTrip trip = ALARM_DEFAULT_RATE_TRIP;
+	int64_t power_on = 0, offset = 0;
+	int have_power_on = 0, millis = 0, quiet = 0;
+	const char *path = 0;
+
+	for(int i = 1; i < argc; i++){
+		const char *arg = argv[i];
+		const char *value = i+1 < argc ? argv[i+1] : 0;
+		if(strcmp(arg, "-p") == 0 && value && parse_milli(&value, &power_on) && *value == '\0'){
+			have_power_on = 1;
+			i++;
+		}else if(strcmp(arg, "-o") == 0 && value && parse_milli(&value, &offset) && *value == '\0'){
+			i++;
+		}else if(strcmp(arg, "-r") == 0 && value && parse_rule(value, rules)){
+			i++;
+		}else if(strcmp(arg, "-t") == 0 && value){
+			int64_t on, off;
+			if(!parse_milli(&value, &on) || *value++ != ',' || !parse_milli(&value, &off) || *value != '\0'){
+				usage();
+			}
+			trip.on_rate = on;
+			trip.off_rate = off;
+			i++;
+		}else if(strcmp(arg, "-m") == 0){
+			millis = 1;
+		}else if(strcmp(arg, "-q") == 0){
+			quiet = 1;
+		}else if(arg[0] == '-' && arg[1] != '\0'){
+			usage();
+		}else if(path == 0){
+			path = arg;
+		}else{
+			usage();
+		}
+	}
+
+	FILE *in = stdin;
+	if(path != 0 && strcmp(path, "-") != 0){
+		in = fopen(path, "rb");
+		if(in == 0){
+			perror(path);
+			return 1;
+		}
+	}
+
+	static char buffer[CHUNK + 1];
+	static AlarmCore core;
+	LoadSummary summary[NUM_LOADS];
+	uint64_t rate_trips = 0;
+	memset(summary, 0, sizeof(summary));
+	uint64_t samples = 0, bad = 0;
+	uint64_t start_ms = 0, now_ms = 0;
+	uint32_t loads = 0;
+
+	printf("time_s,load,state,value\n");
+	struct timespec host_start, host_end;
+	clock_gettime(CLOCK_MONOTONIC, &host_start);
+
+	size_t kept = 0;
+	int eof = 0;
+	while(!eof){
+		size_t got = fread(buffer + kept, 1, CHUNK - kept, in);
+		size_t len = kept + got;
+		eof = got == 0;
+		if(eof && len > 0 && buffer[len-1] != '\n'){
+			buffer[len++] = '\n';
+		}
+		buffer[len] = '\0';
+
+		const char *line = buffer;
+		const char *end;
+		while((end = memchr(line, '\n', buffer + len - line)) != 0){
+			const char *p = line;
+			int64_t time, milliF;
+			int numeric = (*p >= '0' && *p <= '9') || *p == '-' || *p == '.';
+			line = end + 1;
+			if(!parse_milli(&p, &time) || *p++ != ',' || !parse_milli(&p, &milliF)){
+				bad += numeric;
+				continue;
+			}
+			uint64_t t_ms = millis ? time / 1000 : time;
+			if(samples == 0){
+				start_ms = t_ms;
+				if(!have_power_on){
+					power_on = milliF;
+				}
+				alarm_init(&core, rules, &trip, power_on, (uint32_t)t_ms);
+				alarm_set_offset(&core, offset);
+			}
+			now_ms = t_ms;
+			samples++;
+
+			AlarmOutput out;
+			alarm_step(&core, milliF, (uint32_t)t_ms, &out);
+
+			if(out.rate_changed){
+				rate_trips += trip.active;
+				if(!quiet){
+					printf("%.3f,rate,%s,%.3f\n", t_ms / 1000.0, trip.active ? "on" : "off", core.rate_milliF / 1000.0);
+				}
+			}
+			for(uint32_t changed = out.changed, load = 0; changed != 0; load++, changed >>= 1){
+				if(!(changed & 1)){
+					continue;
+				}
+				LoadSummary *s = &summary[load];
+				uint8_t on = (out.loads >> load) & 1;
+				if(on){
+					if(s->trips++ == 0){
+						s->first_ms = t_ms;
+					}
+					s->since_ms = t_ms;
+				}else{
+					s->on_ms += t_ms - s->since_ms;
+				}
+				if(!quiet){
+					printf("%.3f,%s,%s,%.3f\n", t_ms / 1000.0, load_names[load], on ? "on" : "off", out.milliF / 1000.0);
+				}
+			}
+			loads = out.loads;
+		}
+
+		kept = buffer + len - line;
+		if(kept == CHUNK){
+			fprintf(stderr, "line too long\n");
+			return 1;
+		}
+		memmove(buffer, line, kept);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &host_end);
+	double host_s = (host_end.tv_sec - host_start.tv_sec) + (host_end.tv_nsec - host_start.tv_nsec) / 1e9;
+	fflush(stdout);
+
+	fprintf(stderr, "samples: %llu, bad lines: %llu\n", (unsigned long long)samples, (unsigned long long)bad);
+	fprintf(stderr, "trace: %.1f hours, power-on %.3f F\n", (now_ms - start_ms) / 3600000.0, power_on / 1000.0);
+	for(int load = 0; load < NUM_LOADS; load++){
+		LoadSummary *s = &summary[load];
+		uint64_t on_ms = s->on_ms + (((loads >> load) & 1) ? now_ms - s->since_ms : 0);
+		fprintf(stderr, "%-6s trips: %llu", load_names[load], (unsigned long long)s->trips);
+		if(s->trips){
+			fprintf(stderr, ", first at %.3f s, on for %.1f s", (s->first_ms - start_ms) / 1000.0, on_ms / 1000.0);
+		}
+		fprintf(stderr, "\n");
+	}
+	fprintf(stderr, "rate   trips: %llu\n", (unsigned long long)rate_trips);
+	fprintf(stderr, "host: %.3f s, %.0f samples/s\n", host_s, host_s > 0 ? samples / host_s : 0);
+	return 0;
+}
+
+/*
+ * Parses a decimal number into thousandths, ignoring digits past the third
+ * decimal place. Leaves *text after the number.
+ * Inputs:
+ * 		**text - number, may be signed
+ * 		*value - result
+ * Outputs:
+ * 		1 on success, 0 if no digits were found
+ */
+static int parse_milli(const char **text, int64_t *value){
+	const char *p = *text;
+	int64_t sign = 1, whole = 0, frac = 0;
+	int digits = 0, places = 0;
+	while(*p == ' '){
+		p++;
+	}
+	if(*p == '-' || *p == '+'){
+		sign = *p++ == '-' ? -1 : 1;
+	}
+	for(; *p >= '0' && *p <= '9'; p++, digits++){
+		whole = whole*10 + (*p - '0');
+	}
+	if(*p == '.'){
+		for(p++; *p >= '0' && *p <= '9'; p++, digits++){
+			if(places < 3){
+				frac = frac*10 + (*p - '0');
+				places++;
+			}
+		}
+	}
+	while(places++ < 3){
+		frac *= 10;
+	}
+	*text = p;
+	*value = sign * (whole*1000 + frac);
+	return digits > 0;
+}
+
+/*
+ * Parses a -r rule: load name, on and off rise in F, then the hold times.
+ */
+static int parse_rule(const char *text, Rule *rules){
+	for(int load = 0; load < NUM_LOADS; load++){
+		size_t n = strlen(load_names[load]);
+		if(strncmp(text, load_names[load], n) != 0 || text[n] != ','){
+			continue;
+		}
+		const char *p = text + n + 1;
+		int64_t on, off, min_on, min_off;
+		if(!parse_milli(&p, &on) || *p++ != ',' || !parse_milli(&p, &off) || *p++ != ','
+				|| !parse_milli(&p, &min_on) || *p++ != ',' || !parse_milli(&p, &min_off) || *p != '\0'){
+			return 0;
+		}
+		rules[load].on_milliF = on;
+		rules[load].off_milliF = off;
+		rules[load].min_on_ms = min_on / 1000;
+		rules[load].min_off_ms = min_off / 1000;
+		return 1;
+	}
+	return 0;
+}
+
+static void usage(){
+	fprintf(stderr,
+			"usage: replay [-p power_on_F] [-o offset_F] [-r load,on_F,off_F,min_on_ms,min_off_ms]\n"
+			"              [-t on_F_per_min,off_F_per_min] [-m] [-q] [trace.csv]\n"
+			"  rows are time,temperature with time in seconds, or milliseconds with -m\n");
+	exit(2);
+}
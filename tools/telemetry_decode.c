@@ -0,0 +1,139 @@
+/*
+ * telemetry_decode.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * Host side decoder for the controller telemetry stream. Reads the raw console
+ * byte stream from a serial port, pty or file, splits it on zero delimiters,
+ * checks each frame and writes one CSV row per sample to stdout. Console text
+ * mixed into the stream is skipped. A summary of good and bad frames and of
+ * sequence gaps is written to stderr at the end.
+ *
+ * Build:
+ * 		cc -O2 -Iinc -o telemetry_decode tools/telemetry_decode.c src/telemetry_frame.c src/cobs.c
+ * Use:
+ * 		telemetry_decode /dev/ttyACM0 [baud] > log.csv
+ * 		telemetry_decode -g 1000 > /dev/pts/N	(generate test frames, for pty loopback)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+
+#include "telemetry.h"
+
+#define MAX_CHUNK 256
+
+static speed_t baud_constant(long baud);
+static int generate(long count);
+
+int main(int argc, char **argv){
+	if(argc >= 3 && strcmp(argv[1], "-g") == 0){
+		return generate(atol(argv[2]));
+	}
+
+	int fd = 0;
+	if(argc >= 2 && strcmp(argv[1], "-") != 0){
+		fd = open(argv[1], O_RDONLY | O_NOCTTY);
+		if(fd < 0){
+			perror(argv[1]);
+			return 1;
+		}
+	}
+
+	//put serial ports and ptys into raw mode at the requested baud
+	struct termios tio;
+	if(tcgetattr(fd, &tio) == 0){
+		cfmakeraw(&tio);
+		speed_t speed = baud_constant(argc >= 3 ? atol(argv[2]) : 115200);
+		cfsetispeed(&tio, speed);
+		cfsetospeed(&tio, speed);
+		tcsetattr(fd, TCSANOW, &tio);
+	}
+
+	uint8_t buf[4096];
+	uint8_t chunk[MAX_CHUNK];
+	uint32_t chunk_len = 0;
+	unsigned long good = 0, bad = 0, gaps = 0;
+	uint16_t next_seq = 0;
+	TelemetrySample sample;
+
+	printf("seq,time_ms,raw,temp_F,offset_F,led_duty,fan_duty,siren_duty\n");
+
+	ssize_t n;
+	while((n = read(fd, buf, sizeof(buf))) > 0){
+		for(ssize_t i = 0; i < n; i++){
+			if(buf[i] != 0){
+				//only the first MAX_CHUNK bytes are kept, a longer chunk is console
+				//text and is dropped whole at its delimiter
+				if(chunk_len < MAX_CHUNK){
+					chunk[chunk_len] = buf[i];
+				}
+				chunk_len++;
+				continue;
+			}
+			if(chunk_len == 0){
+				continue;
+			}
+
+			if(chunk_len <= MAX_CHUNK && telemetry_unpack(chunk, chunk_len, &sample) == 0){
+				if(good != 0 && sample.seq != next_seq){
+					gaps++;
+				}
+				next_seq = sample.seq + 1;
+				good++;
+				printf("%u,%u,%u,%.3f,%.3f,%u,%u,%u\n", sample.seq, sample.time_ms, sample.raw,
+						sample.temp_milliF / 1000.0, sample.offset_milliF / 1000.0,
+						sample.duty[0], sample.duty[1], sample.duty[2]);
+			}else{
+				bad++;
+			}
+			chunk_len = 0;
+		}
+	}
+
+	fflush(stdout);
+	fprintf(stderr, "frames: %lu good, %lu bad, %lu sequence gaps\n", good, bad, gaps);
+	return 0;
+}
+
+static speed_t baud_constant(long baud){
+	switch(baud){
+		case 9600:		return B9600;
+		case 19200:		return B19200;
+		case 38400:		return B38400;
+		case 57600:		return B57600;
+		case 230400:	return B230400;
+		case 460800:	return B460800;
+		case 921600:	return B921600;
+		default:		return B115200;
+	}
+}
+
+/*
+ * Writes count synthetic frames to stdout, a slow temperature ramp with the
+ * loads switching on part way, for testing the decoder over a pty pair.
+ */
+static int generate(long count){
+	uint8_t wire[TELEMETRY_WIRE_SIZE];
+	TelemetrySample sample;
+	memset(&sample, 0, sizeof(sample));
+
+	for(long i = 0; i < count; i++){
+		sample.seq = i;
+		sample.time_ms = i * TELEMETRY_PERIOD;
+		sample.raw = 900 + (i % 100);
+		sample.temp_milliF = 70000 + i * 10;
+		sample.offset_milliF = 0;
+		for(int load = 0; load < TELEMETRY_LOADS; load++){
+			sample.duty[load] = (i > count/2) ? 1000 : 0;
+		}
+		fwrite(wire, 1, telemetry_pack(&sample, wire), stdout);
+	}
+	fflush(stdout);
+	return 0;
+}
@@ -0,0 +1,126 @@
+/*
+ * trace_decode.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mitchell Larson
+ *
+ * Host side decoder for the `trace dump` console output. Reads a console
+ * capture, finds each dump between its "trace" and "trace end" lines and writes
+ * one CSV row per record to stdout: the time since the first record and since
+ * the previous one in microseconds, the trace point name and its argument.
+ * Other console text is skipped. Cycle counts wrap every 2^32 cycles, so
+ * consecutive records are assumed to be less than one wrap apart, which holds
+ * while the sample event is traced.
+ *
+ * Build:
+ * 		cc -O2 -Iinc -o trace_decode tools/trace_decode.c
+ * Use:
+ * 		trace_decode console.log > trace.csv
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace.h"
+
+int main(int argc, char **argv){
+	static const char *trace_names[NUM_TRACE_IDS] = TRACE_NAMES;
+	//in Event order, see event.h
+	static const char *event_names[] = {
+		"alarm", "sample", "telemetry", "keypad", "console", "display", "persist", "tasks"
+	};
+	#define NUM_EVENT_NAMES (sizeof(event_names) / sizeof(event_names[0]))
+
+	FILE *in = stdin;
+	if(argc >= 2 && strcmp(argv[1], "-") != 0){
+		in = fopen(argv[1], "r");
+		if(in == 0){
+			perror(argv[1]);
+			return 1;
+		}
+	}
+
+	char line[256];
+	int in_dump = 0;
+	unsigned long dumps = 0, records = 0, bad = 0;
+	unsigned long hz = 0;
+	uint32_t prev = 0;
+	unsigned long long elapsed = 0;
+	unsigned long index = 0;
+
+	printf("dump,index,time_us,delta_us,id,arg\n");
+	while(fgets(line, sizeof(line), in) != 0){
+		line[strcspn(line, "\r\n")] = '\0';
+		unsigned long count;
+
+		//the header may follow a shell prompt on the same line
+		const char *header = strstr(line, "trace ");
+		if(header != 0 && strcmp(header, "trace end") == 0){
+			in_dump = 0;
+			continue;
+		}
+		if(header != 0 && sscanf(header, "trace %lu %lu", &count, &hz) == 2 && hz != 0){
+			in_dump = 1;
+			dumps++;
+			index = 0;
+			elapsed = 0;
+			continue;
+		}
+		if(!in_dump){
+			continue;
+		}
+
+		char *end;
+		if(strlen(line) != 16){
+			bad++;
+			continue;
+		}
+		unsigned long long value = strtoull(line, &end, 16);
+		if(*end != '\0'){
+			bad++;
+			continue;
+		}
+		uint32_t cycles = value >> 32;
+		uint16_t id = value & 0xFFFF;
+		uint16_t arg = (value >> 16) & 0xFFFF;
+
+		uint32_t delta = index == 0 ? 0 : cycles - prev;
+		prev = cycles;
+		elapsed += delta;
+
+		printf("%lu,%lu,%.3f,%.3f,", dumps, index, elapsed * 1e6 / hz, delta * 1e6 / hz);
+		if(id < NUM_TRACE_IDS){
+			printf("%s,", trace_names[id]);
+		}else{
+			printf("%u,", id);
+		}
+		switch(id){
+			case TRACE_EVENT:
+				if(arg < NUM_EVENT_NAMES){
+					printf("%s\n", event_names[arg]);
+				}else{
+					printf("%u\n", arg);
+				}
+				break;
+			case TRACE_TEMP:
+				printf("%.1f\n", (int16_t)arg / 10.0);
+				break;
+			case TRACE_KEY:
+				printf("%c\n", arg >= ' ' && arg < 0x7F ? arg : '?');
+				break;
+			case TRACE_LOADS:
+				printf("0x%x\n", arg);
+				break;
+			default:
+				printf("%u\n", arg);
+				break;
+		}
+		index++;
+		records++;
+	}
+
+	fflush(stdout);
+	fprintf(stderr, "dumps: %lu, records: %lu, bad lines: %lu\n", dumps, records, bad);
+	return 0;
+}